@@ -0,0 +1,209 @@
+#include <stdint.h>
+#include <string.h>
+#include "alloc.h"
+#include "util.h"
+
+/*system*/
+static void *system_alloc(void *ctx, size_t sz) {
+    return xmalloc(sz);
+}
+static void system_free(void *ctx, void *m, size_t sz) {
+    xfree(m);
+}
+static void system_deinit(void *ctx) {
+}
+
+static struct allocator system_allocator = {
+    "system", system_alloc, system_free, system_deinit, NULL
+};
+struct allocator *ll_allocator = &system_allocator;
+
+
+/*chunks are kept in a singly linked list through their first bytes*/
+#define CHUNK_SIZE (1024 * 1024)
+#define CHUNK_HEADER 16 //keeps the payload 16 byte aligned
+
+struct chunks {
+    void *head;
+};
+static unsigned char *chunks_new(struct chunks *c, size_t sz) {
+    unsigned char *chunk = xmalloc(sz + CHUNK_HEADER);
+    *(void **)chunk = c->head;
+    c->head = chunk;
+    return chunk + CHUNK_HEADER;
+}
+static void chunks_free(struct chunks *c) {
+    while (c->head) {
+        void *next = *(void **)c->head;
+        xfree(c->head);
+        c->head = next;
+    }
+}
+
+
+/*bump*/
+struct bump {
+    struct chunks chunks;
+    unsigned char *cur;
+    size_t left;
+};
+static void *bump_alloc(void *ctx, size_t sz) {
+    struct bump *b = ctx;
+    sz = (sz + 15) & ~(size_t)15;
+    if (sz > CHUNK_SIZE / 4)
+        return chunks_new(&b->chunks, sz); //don't waste a whole chunk's tail on it
+    if (sz > b->left) {
+        b->cur = chunks_new(&b->chunks, CHUNK_SIZE);
+        b->left = CHUNK_SIZE;
+    }
+    void *m = b->cur;
+    b->cur += sz;
+    b->left -= sz;
+    return m;
+}
+static void bump_free(void *ctx, void *m, size_t sz) {
+}
+static void bump_deinit(void *ctx) {
+    struct bump *b = ctx;
+    chunks_free(&b->chunks);
+    xfree(b);
+}
+
+
+/*slab*/
+#define SLAB_MIN_SHIFT 4
+#define SLAB_N_CLASSES 8 //16 .. 2048
+
+struct slab {
+    struct chunks chunks;
+    void *free_lists[SLAB_N_CLASSES];
+    unsigned char *cur;
+    size_t left;
+};
+static int slab_class(size_t sz) {
+    int c = 0;
+    while (((size_t)1 << (c + SLAB_MIN_SHIFT)) < sz)
+        c++;
+    return c;
+}
+static void *slab_alloc(void *ctx, size_t sz) {
+    struct slab *s = ctx;
+    int c = slab_class(sz);
+    if (c >= SLAB_N_CLASSES)
+        return xmalloc(sz);
+    void *m = s->free_lists[c];
+    if (m) {
+        s->free_lists[c] = *(void **)m;
+        return m;
+    }
+    size_t class_sz = (size_t)1 << (c + SLAB_MIN_SHIFT);
+    if (class_sz > s->left) {
+        //the tail of the old chunk is lost, at most 2KB per 1MB
+        s->cur = chunks_new(&s->chunks, CHUNK_SIZE);
+        s->left = CHUNK_SIZE;
+    }
+    m = s->cur;
+    s->cur += class_sz;
+    s->left -= class_sz;
+    return m;
+}
+static void slab_free(void *ctx, void *m, size_t sz) {
+    struct slab *s = ctx;
+    int c = slab_class(sz);
+    if (c >= SLAB_N_CLASSES) {
+        xfree(m);
+        return;
+    }
+    *(void **)m = s->free_lists[c];
+    s->free_lists[c] = m;
+}
+static void slab_deinit(void *ctx) {
+    struct slab *s = ctx;
+    chunks_free(&s->chunks);
+    xfree(s);
+}
+
+
+void allocator_init(struct allocator *a, enum allocator_kind kind)
+{
+    switch (kind) {
+        case ALLOCATOR_BUMP: {
+            struct bump *b = xmalloc(sizeof *b);
+            memset(b, 0, sizeof *b);
+            *a = (struct allocator){"bump", bump_alloc, bump_free, bump_deinit, b};
+            break;
+        }
+        case ALLOCATOR_SLAB: {
+            struct slab *s = xmalloc(sizeof *s);
+            memset(s, 0, sizeof *s);
+            *a = (struct allocator){"slab", slab_alloc, slab_free, slab_deinit, s};
+            break;
+        }
+        default:
+            *a = system_allocator;
+            break;
+    }
+}
+
+void allocator_deinit(struct allocator *a)
+{
+    a->deinit(a->ctx);
+    a->ctx = NULL;
+    if (ll_allocator == a)
+        ll_allocator = &system_allocator; //later ll_node_alloc() calls would use the freed context
+}
+
+
+/*heap fragmentation engine*/
+static uint32_t heap_frag_rand(struct heap_frag *f) {
+    uint32_t x = f->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return f->rng = x;
+}
+static size_t heap_frag_size(struct heap_frag *f) {
+    uint32_t r = heap_frag_rand(f) % 100;
+    if (r < 60)
+        return 16 + heap_frag_rand(f) % 48;    //16..63
+    if (r < 90)
+        return 64 + heap_frag_rand(f) % 448;   //64..511
+    return 512 + heap_frag_rand(f) % 3584;     //512..4095
+}
+
+void heap_frag_init(struct heap_frag *f, int level)
+{
+    memset(f, 0, sizeof *f);
+    f->level = level;
+    f->rng = 0x9E3779B9; //any non zero seed
+}
+
+void heap_frag_step(struct heap_frag *f)
+{
+    size_t max_live = (size_t)f->level * HEAP_FRAG_LIVE_PER_LEVEL;
+    for (int i=0; i<f->level; i++) {
+        if (f->n_ptrs == f->cap) {
+            f->cap = f->cap ? f->cap * 2 : 1024;
+            f->ptrs = xrealloc(f->ptrs, f->cap * sizeof(void *));
+        }
+        unsigned char *m = xmalloc(heap_frag_size(f));
+        m[0] = 0xFF;
+        f->ptrs[f->n_ptrs++] = m;
+        f->n_allocs++;
+        //free a random live block half the time, and always once the live set is full
+        if ((heap_frag_rand(f) & 1) || f->n_ptrs > max_live) {
+            size_t victim = heap_frag_rand(f) % f->n_ptrs;
+            xfree(f->ptrs[victim]);
+            f->ptrs[victim] = f->ptrs[--f->n_ptrs];
+            f->n_frees++;
+        }
+    }
+}
+
+void heap_frag_deinit(struct heap_frag *f)
+{
+    for (size_t i=0; i<f->n_ptrs; i++)
+        xfree(f->ptrs[i]);
+    xfree(f->ptrs);
+    memset(f, 0, sizeof *f);
+}
@@ -0,0 +1,55 @@
+#ifndef ALLOC_H
+#define ALLOC_H
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ *  pluggable allocators for the classic list baseline (ll_node_alloc() and friends)
+ *  so the pool list can be compared against more than the system malloc
+ *
+ *  system: xmalloc()/xfree()
+ *  bump:   carves 1MB chunks sequentially, free is a no-op, memory comes back on deinit
+ *  slab:   power of 2 size classes (16..2048) with per class free lists, larger sizes go to xmalloc()
+ */
+struct allocator {
+    const char *name;
+    void *(*alloc)(void *ctx, size_t sz);
+    void (*free)(void *ctx, void *m, size_t sz); //sz is the size passed to alloc
+    void (*deinit)(void *ctx);
+    void *ctx;
+};
+
+enum allocator_kind { ALLOCATOR_SYSTEM, ALLOCATOR_BUMP, ALLOCATOR_SLAB, N_ALLOCATORS };
+
+/*used by ll_node_alloc()/ll_node_free(), defaults to the system allocator*/
+extern struct allocator *ll_allocator;
+
+void allocator_init(struct allocator *a, enum allocator_kind kind);
+/*releases everything allocated through a, ll_allocator falls back to the system allocator if it was a*/
+void allocator_deinit(struct allocator *a);
+
+
+/*
+ *  heap fragmentation engine
+ *  every step allocates 'level' long lived blocks of mixed size classes (mostly small, some up
+ *  to 4KB) and frees random live ones, so list nodes allocated in between end up scattered
+ *  among holes of different sizes, the live set is capped at level * HEAP_FRAG_LIVE_PER_LEVEL
+ *  it draws from its own random stream, rand() is left alone so the workload is the same at every level
+ */
+#define HEAP_FRAG_LIVE_PER_LEVEL 16384
+
+struct heap_frag {
+    int level;
+    void **ptrs;
+    size_t n_ptrs;
+    size_t cap;
+    long n_allocs;
+    long n_frees;
+    uint32_t rng; //xorshift32 state
+};
+
+void heap_frag_init(struct heap_frag *f, int level);
+void heap_frag_step(struct heap_frag *f);
+void heap_frag_deinit(struct heap_frag *f);
+
+#endif /*ALLOC_H*/
@@ -2,17 +2,23 @@
 #include <stdlib.h>
 #include "linkedlist.h"
 #include "plinkedlist.h"
+#include "ll_hashmap.h"
+#include "pll_hashmap.h"
+#include "pll_lru.h"
+#include "ll_sort.h"
+#include "pll_sort.h"
+#include "pll_validate.h"
 #include "util.h"
 #include "bench_util.h"
 #include "timer.h"
+#include "perf_counters.h"
+#include "alloc.h"
 
 
 #define N_HEADS_NODES 1000
 //higher number: less chance
 #define REPLACE_CHANCE 128
 #define DELETE_CHANCE 8
-#define RUIN_CHANCE   32
-#define MAX_HEAP_PTRS 20000
 
 
 static struct opts {
@@ -21,8 +27,18 @@ static struct opts {
     int enable_ll;
     int enable_pll;
     int ruin_heap;
+    int allocator;
+    int bench_map;
+    int bench_lru;
+    int lru_cap;
+    int bench_sort;
+    int alloc_sample;
+    int no_perf;
 } opts;
 
+enum phase { PHASE_INSERTS, PHASE_CHECKSUM, PHASE_DELETES, PHASE_REINSERTS, N_PHASES };
+static const char *phase_names[N_PHASES] = {"inserts", "checksum", "deletes", "reinserts"};
+
 struct stats {
     long n_alloc;
     long n_dealloc;
@@ -32,12 +48,18 @@ struct stats {
     double insert_time;
     double delete_time;
     double exc_alloc_time;
+    struct perf_sample perf[N_PHASES];
 };
 
 static struct stats pll_stats = {0};
 static struct stats ll_stats = {0};
 
 static struct timer_info tinfo;
+static struct perf_counters perf;
+static struct allocator ll_alloc;
+//exclusive allocation time, sampled since timing every call costs more than the allocation
+static struct tcounter pll_alloc_counter;
+static struct tcounter ll_alloc_counter;
 
 void dump_stats(const char *name, struct stats *st)
 {
@@ -63,38 +85,55 @@ void dump_stats(const char *name, struct stats *st)
     st->checksum_time,
     st->delete_time,
     st->exc_alloc_time); //printf
-}
 
-struct heap_info {
-    int n_ptrs;
-    void *heap_ptrs[MAX_HEAP_PTRS];
-};
-static struct heap_info pll_hinfo = {0};
-static struct heap_info ll_hinfo = {0};
-
-bool ruin_heap(struct heap_info *h) {
-    if (h->n_ptrs >= MAX_HEAP_PTRS)
-        return false;
-    //maximum: 2^10 bytes, which is peanuts
-    for (int i=0; (i < 10) && (h->n_ptrs < MAX_HEAP_PTRS); i++) {
-        if (rand()%2) {
-            unsigned char *m = xmalloc(1U << i);
-            m[0] = 0xFF;
-            h->heap_ptrs[h->n_ptrs++] = m;
-            if (h->n_ptrs == MAX_HEAP_PTRS)
-                break;
+    if (!perf_counters_any_available(&perf)) {
+        printf("\tperf counters:   unavailable\n");
+        return;
+    }
+    printf("\t%-15s", "perf counters:");
+    for (int e=0; e<PERF_N_EVENTS; e++)
+        printf(" %14s", perf_event_name(e));
+    printf("\n");
+    for (int p=0; p<N_PHASES; p++) {
+        printf("\t  %-13s", phase_names[p]);
+        for (int e=0; e<PERF_N_EVENTS; e++) {
+            if (perf_counters_available(&perf, e) && !st->perf[p].missed[e])
+                printf(" %14lld", st->perf[p].values[e]);
+            else
+                printf(" %14s", "n/a");
         }
+        printf("\n");
     }
-    return true;
 }
-void unruin_heap(struct heap_info *h) {
-    for (int i=h->n_ptrs-1; i>=0; i--) {
-        xfree(h->heap_ptrs[i]);
-        h->heap_ptrs[i] = NULL;
-    }
-    h->n_ptrs = 0;
+
+void dump_pll_list_stats(struct pll_list *list)
+{
+    struct pll_list_stats ls;
+    pll_list_stats(list, &ls, 16);
+    printf(
+"pool stats:\n"
+"\tn_live:            %zu\n"
+"\tcap:               %zu\n"
+"\thighest_live:      %ld\n"
+"\toccupancy:         %.3f\n"
+"\tdensity:           %.3f\n"
+"\tavg_link_distance: %.1f\n"
+"\tdata_bytes:        %zu\n"
+"\tbitset_bytes:      %zu\n",
+    ls.n_live,
+    ls.cap,
+    ls.highest_live,
+    ls.occupancy,
+    ls.density,
+    ls.avg_link_distance,
+    ls.data_bytes,
+    ls.bitset_bytes); //printf
 }
 
+//long lived allocations interleaved with the nodes, see heap_frag_step()
+static struct heap_frag pll_frag;
+static struct heap_frag ll_frag;
+
 
 //pool allocated linked list
 static struct pll_list *pll = NULL;
@@ -148,10 +187,9 @@ static unsigned ll_iter_nodes_checksum() {
 }
 
 static node_idx pll_insert(struct pll_list *list, node_idx at, int value) {
-    struct timer_info tmp;
-    timer_begin(&tmp);
+    uint64_t t = tcounter_begin(&pll_alloc_counter);
     node_idx tail = pll_node_alloc(list);
-    pll_stats.exc_alloc_time += timer_dt(&tmp);
+    tcounter_end(&pll_alloc_counter, t);
 
     struct pll_node *at_node = pll_list_get(list, at);
     struct pll_node *tail_node = pll_list_get(list, tail);
@@ -162,10 +200,9 @@ static node_idx pll_insert(struct pll_list *list, node_idx at, int value) {
     return tail;
 }
 static struct ll_node *ll_insert(struct ll_node *node, int value) {
-    struct timer_info tmp;
-    timer_begin(&tmp);
+    uint64_t t = tcounter_begin(&ll_alloc_counter);
     struct ll_node *tail_node = ll_node_alloc();
-    ll_stats.exc_alloc_time += timer_dt(&tmp);
+    tcounter_end(&ll_alloc_counter, t);
 
 
     tail_node->next = node->next;
@@ -193,12 +230,8 @@ void pll_random_inserts()
             pll_heads_nodes[pll_value_num % N_HEADS_NODES] = new_node;
             pll_stats.n_heads_replace++;
         }
-        if (opts.ruin_heap && ((rnd % RUIN_CHANCE) == 0)) {
-            if (ruin_heap(&pll_hinfo))
-                pll_stats.n_ruin_heap++;
-            else
-                unruin_heap(&pll_hinfo);
-        }
+        if (opts.ruin_heap)
+            heap_frag_step(&pll_frag);
         pll_value_num++;
     }
 }
@@ -220,12 +253,8 @@ void ll_random_inserts()
             ll_heads_nodes[ll_value_num % N_HEADS_NODES] = new_node;
             ll_stats.n_heads_replace++;
         }
-        if (opts.ruin_heap && ((rnd % RUIN_CHANCE) == 0)) {
-            if (ruin_heap(&ll_hinfo))
-                ll_stats.n_ruin_heap++;
-            else
-                unruin_heap(&ll_hinfo);
-        }
+        if (opts.ruin_heap)
+            heap_frag_step(&ll_frag);
         ll_value_num++;
     }
 }
@@ -302,66 +331,373 @@ void parse_argv(int argc, const char **argv)
     if (argv_get_int(argc, argv, "-h", &opts.help, 0)) opts.help = 1;
     if (argv_get_int(argc, argv, "--enable-pll", &opts.enable_pll, 0)) opts.enable_pll = 1;
     if (argv_get_int(argc, argv, "--enable-ll", &opts.enable_ll,  0)) opts.enable_ll = 1;
-    if (argv_get_int(argc, argv, "--ruin-heap", &opts.ruin_heap, 0)) opts.ruin_heap = 1;
+    if (argv_get_int(argc, argv, "--ruin-heap", &opts.ruin_heap, 0) && !opts.ruin_heap) opts.ruin_heap = 1;
+    argv_get_int(argc, argv, "--allocator", &opts.allocator, ALLOCATOR_SYSTEM);
+    if (argv_get_int(argc, argv, "--bench-map", &opts.bench_map, 0)) opts.bench_map = 1;
+    if (argv_get_int(argc, argv, "--bench-lru", &opts.bench_lru, 0)) opts.bench_lru = 1;
+    if (argv_get_int(argc, argv, "--bench-sort", &opts.bench_sort, 0)) opts.bench_sort = 1;
+    if (argv_get_int(argc, argv, "--no-perf", &opts.no_perf, 0)) opts.no_perf = 1;
+    argv_get_int(argc, argv, "--alloc-sample", &opts.alloc_sample, 64);
+    argv_get_int(argc, argv, "--lru-cap", &opts.lru_cap, opts.n_iters / 10 + 1);
     if (opts.help) {
         printf(
         "Options:\n"
         "\t-n\tnumber of iterations.\n"
         "\t--enable-ll\tenable classic linked list\n"
         "\t--enable-pll\tenable pool allocated linked list\n"
-        "\t--ruin-heap\tattempt to simulate heap fragmentation, \n"
-        "\tthis actually makes things faster instead of the intended result (default: off)\n"
+        "\t--ruin-heap\tfragment the heap while inserting, the level is the number of long lived\n"
+        "\tallocations of mixed sizes made (and randomly freed) per inserted node (default: off, 1 if no level)\n"
+        "\t--allocator\tallocator behind the classic list nodes, 0: system, 1: bump, 2: slab (default: 0)\n"
+        "\t--no-perf\tdo not collect hardware performance counters\n"
+        "\t--alloc-sample\ttime 1 in N allocations for exc_alloc_time (default: 64)\n"
+        "\t--bench-map\tbenchmark pll_hashmap against a malloc per node chained map instead\n"
+        "\t--bench-lru\trun a zipf distributed trace of n gets over n keys through pll_lru instead\n"
+        "\t--lru-cap\tnumber of entries the lru cache can hold (default: n / 10)\n"
+        "\t--bench-sort\tsort n randomly inserted nodes with pll merge/radix sort and ll merge sort instead\n"
         ); //printf
         exit(0);
     }
     if (!opts.enable_ll && !opts.enable_pll) {
         opts.enable_ll = opts.enable_pll = 1;
     }
-    printf("bench\tn_iters: %d, ruin_heap:%d\n", opts.n_iters, opts.ruin_heap);
+    if (opts.allocator < 0 || opts.allocator >= N_ALLOCATORS)
+        die("unknown --allocator\n");
+    printf("bench\tn_iters: %d, ruin_heap:%d, allocator:%d\n", opts.n_iters, opts.ruin_heap, opts.allocator);
 }
 
-static void do_inserts() {
+static void do_inserts(enum phase phase) {
     if (opts.enable_pll) {
+        perf_counters_start(&perf);
         timer_begin(&tinfo);
         pll_random_inserts();
         pll_stats.insert_time += timer_dt(&tinfo);
+        perf_counters_stop(&perf, &pll_stats.perf[phase]);
     }
     if (opts.enable_ll) {
+        perf_counters_start(&perf);
         timer_begin(&tinfo);
         ll_random_inserts();
         ll_stats.insert_time += timer_dt(&tinfo);
+        perf_counters_stop(&perf, &ll_stats.perf[phase]);
     }
 }
 static void do_deletes() {
     if (opts.enable_pll) {
+        perf_counters_start(&perf);
         timer_begin(&tinfo);
         pll_random_deletes();
         pll_stats.delete_time += timer_dt(&tinfo);
+        perf_counters_stop(&perf, &pll_stats.perf[PHASE_DELETES]);
     }
     if (opts.enable_ll) {
+        perf_counters_start(&perf);
         timer_begin(&tinfo);
         ll_random_deletes();
         ll_stats.delete_time += timer_dt(&tinfo);
+        perf_counters_stop(&perf, &ll_stats.perf[PHASE_DELETES]);
     }
 }
 static void do_checksums(int *pll_hash, int *ll_hash) {
+    //printing is kept out of the measured region
     if (opts.enable_pll) {
+        perf_counters_start(&perf);
         timer_begin(&tinfo);
         *pll_hash = pll_iter_nodes_checksum();
-        printf("\tpll_hash: %u\n", *pll_hash);
         pll_stats.checksum_time += timer_dt(&tinfo);
+        perf_counters_stop(&perf, &pll_stats.perf[PHASE_CHECKSUM]);
+        printf("\tpll_hash: %u\n", *pll_hash);
     }
     if (opts.enable_ll) {
+        perf_counters_start(&perf);
         timer_begin(&tinfo);
         *ll_hash = ll_iter_nodes_checksum();
-        printf("\tll_hash:  %u\n", *ll_hash);
         ll_stats.checksum_time += timer_dt(&tinfo);
+        perf_counters_stop(&perf, &ll_stats.perf[PHASE_CHECKSUM]);
+        printf("\tll_hash:  %u\n", *ll_hash);
+    }
+}
+
+
+/*hash map benchmark: n puts, n gets, n/2 removes, n gets, keys are drawn from [0, 2n)*/
+struct map_stats {
+    long n_hits;
+    unsigned checksum;
+    double put_time;
+    double get_time;
+    double remove_time;
+};
+
+static void pll_map_bench(struct map_stats *st)
+{
+    struct pll_hashmap map;
+    pll_hashmap_init(&map, 0);
+    int key_range = opts.n_iters * 2;
+    int val;
+
+    srand(0xBEEF);
+    timer_begin(&tinfo);
+    for (int i=0; i<opts.n_iters; i++)
+        pll_hashmap_put(&map, rand() % key_range, i);
+    st->put_time += timer_dt(&tinfo);
+
+    srand(0xFEED);
+    timer_begin(&tinfo);
+    for (int i=0; i<opts.n_iters; i++) {
+        if (pll_hashmap_get(&map, rand() % key_range, &val)) {
+            st->n_hits++;
+            st->checksum += val;
+        }
+    }
+    st->get_time += timer_dt(&tinfo);
+
+    srand(0xDEAD);
+    timer_begin(&tinfo);
+    for (int i=0; i<opts.n_iters / 2; i++)
+        pll_hashmap_remove(&map, rand() % key_range);
+    st->remove_time += timer_dt(&tinfo);
+
+    srand(0xFEED);
+    timer_begin(&tinfo);
+    for (int i=0; i<opts.n_iters; i++) {
+        if (pll_hashmap_get(&map, rand() % key_range, &val)) {
+            st->n_hits++;
+            st->checksum += val;
+        }
+    }
+    st->get_time += timer_dt(&tinfo);
+    pll_hashmap_deinit(&map);
+}
+static void ll_map_bench(struct map_stats *st)
+{
+    struct ll_hashmap map;
+    ll_hashmap_init(&map, 0);
+    int key_range = opts.n_iters * 2;
+    int val;
+
+    srand(0xBEEF);
+    timer_begin(&tinfo);
+    for (int i=0; i<opts.n_iters; i++)
+        ll_hashmap_put(&map, rand() % key_range, i);
+    st->put_time += timer_dt(&tinfo);
+
+    srand(0xFEED);
+    timer_begin(&tinfo);
+    for (int i=0; i<opts.n_iters; i++) {
+        if (ll_hashmap_get(&map, rand() % key_range, &val)) {
+            st->n_hits++;
+            st->checksum += val;
+        }
+    }
+    st->get_time += timer_dt(&tinfo);
+
+    srand(0xDEAD);
+    timer_begin(&tinfo);
+    for (int i=0; i<opts.n_iters / 2; i++)
+        ll_hashmap_remove(&map, rand() % key_range);
+    st->remove_time += timer_dt(&tinfo);
+
+    srand(0xFEED);
+    timer_begin(&tinfo);
+    for (int i=0; i<opts.n_iters; i++) {
+        if (ll_hashmap_get(&map, rand() % key_range, &val)) {
+            st->n_hits++;
+            st->checksum += val;
+        }
+    }
+    st->get_time += timer_dt(&tinfo);
+    ll_hashmap_deinit(&map);
+}
+
+static void dump_map_stats(const char *name, struct map_stats *st)
+{
+    printf(
+"map stats for %s:\n"
+"\tn_hits:          %ld\n"
+"\tchecksum:        %u\n"
+"\ttotal_time:      %.3f\n"
+"\tput_time:        %.3f\n"
+"\tget_time:        %.3f\n"
+"\tremove_time:     %.3f\n",
+    name,
+    st->n_hits,
+    st->checksum,
+    st->put_time + st->get_time + st->remove_time,
+    st->put_time,
+    st->get_time,
+    st->remove_time); //printf
+}
+
+static void do_map_bench() {
+    struct map_stats pll_st, ll_st;
+    memset(&pll_st, 0, sizeof pll_st);
+    memset(&ll_st, 0, sizeof ll_st);
+    if (opts.enable_pll) {
+        pll_map_bench(&pll_st);
+        dump_map_stats("pool allocated chained hash map", &pll_st);
+    }
+    if (opts.enable_ll) {
+        ll_map_bench(&ll_st);
+        dump_map_stats("classic chained hash map", &ll_st);
+    }
+    //both maps ran the same operations
+    if (opts.enable_pll && opts.enable_ll &&
+        (pll_st.n_hits != ll_st.n_hits || pll_st.checksum != ll_st.checksum))
+        die("map benchmarks disagree, n_hits or checksum differ\n");
+}
+
+/*lru benchmark: every miss is followed by a put of the missed key*/
+static void do_lru_bench() {
+    struct pll_lru lru;
+    struct zipf_gen zipf;
+    pll_lru_init(&lru, opts.lru_cap);
+    zipf_init(&zipf, opts.n_iters, 0.99);
+
+    int *trace = xmalloc(opts.n_iters * sizeof(int));
+    srand(0xBEEF);
+    for (int i=0; i<opts.n_iters; i++)
+        trace[i] = zipf_next(&zipf);
+
+    unsigned checksum = 0;
+    int val;
+    timer_begin(&tinfo);
+    for (int i=0; i<opts.n_iters; i++) {
+        if (pll_lru_get(&lru, trace[i], &val))
+            checksum += val;
+        else
+            pll_lru_put(&lru, trace[i], i);
+    }
+    double dt = timer_dt(&tinfo);
+
+    printf(
+"lru stats for pll_lru:\n"
+"\tcapacity:        %d\n"
+"\tn_hits:          %ld\n"
+"\tn_misses:        %ld\n"
+"\tn_evictions:     %ld\n"
+"\thit_rate:        %.3f\n"
+"\tchecksum:        %u\n"
+"\ttotal_time:      %.3f\n"
+"\tops_per_sec:     %.0f\n",
+    opts.lru_cap,
+    lru.n_hits,
+    lru.n_misses,
+    lru.n_evictions,
+    (double)lru.n_hits / opts.n_iters,
+    checksum,
+    dt,
+    opts.n_iters / dt); //printf
+
+    xfree(trace);
+    zipf_deinit(&zipf);
+    pll_lru_deinit(&lru);
+}
+
+/*sort benchmark: both list kinds are built by inserting random values after random earlier nodes*/
+static void pll_build_random(struct pll_list *list, node_idx root) {
+    node_idx heads[N_HEADS_NODES] = {0};
+    srand(0xBEEF);
+    for (int i=0; i<opts.n_iters; i++) {
+        int rnd = rand();
+        node_idx at = heads[rnd % N_HEADS_NODES];
+        node_idx new_node = pll_insert(list, at ? at : root, rand());
+        if (rnd % REPLACE_CHANCE == 0)
+            heads[(rnd / REPLACE_CHANCE) % N_HEADS_NODES] = new_node;
+    }
+}
+static void ll_build_random(struct ll_node *root) {
+    struct ll_node *heads[N_HEADS_NODES] = {NULL};
+    srand(0xBEEF);
+    for (int i=0; i<opts.n_iters; i++) {
+        int rnd = rand();
+        struct ll_node *at = heads[rnd % N_HEADS_NODES];
+        struct ll_node *new_node = ll_insert(at ? at : root, rand());
+        if (rnd % REPLACE_CHANCE == 0)
+            heads[(rnd / REPLACE_CHANCE) % N_HEADS_NODES] = new_node;
+    }
+}
+
+static void dump_sort_stats(const char *name, double sort_time, double checksum_time, unsigned checksum)
+{
+    printf(
+"sort stats for %s:\n"
+"\tchecksum:        %u\n"
+"\tsort_time:       %.3f\n"
+"\tchecksum_time:   %.3f\n",
+    name,
+    checksum,
+    sort_time,
+    checksum_time); //printf
+}
+
+static void do_sort_bench() {
+    double sort_time, checksum_time;
+    unsigned checksum;
+    if (opts.enable_pll) {
+        //run once per sort mode, each on a freshly built pool
+        node_idx (*sorts[2])(struct pll_list *, node_idx) = {pll_sort_merge, pll_sort_radix};
+        const char *names[2] = {"pll merge sort", "pll radix sort + relayout"};
+        for (int m=0; m<2; m++) {
+            struct pll_list list;
+            pll_list_init(&list);
+            pll = &list;
+            pll_root = pll_node_alloc(pll);
+            pll_list_get(pll, pll_root)->value = 0;
+            pll_list_get(pll, pll_root)->next = 0;
+            pll_build_random(pll, pll_root);
+
+            struct pll_node *root_node = pll_list_get(pll, pll_root);
+            timer_begin(&tinfo);
+            root_node->next = sorts[m](pll, root_node->next);
+            sort_time = timer_dt(&tinfo);
+
+            timer_begin(&tinfo);
+            checksum = pll_iter_nodes_checksum();
+            checksum_time = timer_dt(&tinfo);
+            dump_sort_stats(names[m], sort_time, checksum_time, checksum);
+
+            pll_list_deinit(&list);
+            pll = NULL;
+            pll_root = 0;
+        }
+    }
+    if (opts.enable_ll) {
+        ll_root = ll_node_alloc();
+        ll_root->next = NULL;
+        ll_root->value = 0;
+        ll_build_random(ll_root);
+
+        timer_begin(&tinfo);
+        ll_root->next = ll_sort_merge(ll_root->next);
+        sort_time = timer_dt(&tinfo);
+
+        timer_begin(&tinfo);
+        checksum = ll_iter_nodes_checksum();
+        checksum_time = timer_dt(&tinfo);
+        dump_sort_stats("ll merge sort", sort_time, checksum_time, checksum);
+        ll_dealloc();
     }
 }
 
 int main(int argc, const char **argv)
 {
     parse_argv(argc, argv);
+    tcounter_init(&pll_alloc_counter, opts.alloc_sample);
+    tcounter_init(&ll_alloc_counter, opts.alloc_sample);
+    allocator_init(&ll_alloc, opts.allocator);
+    ll_allocator = &ll_alloc;
+
+    if (opts.bench_map) {
+        do_map_bench();
+        return 0;
+    }
+    if (opts.bench_lru) {
+        do_lru_bench();
+        return 0;
+    }
+    if (opts.bench_sort) {
+        do_sort_bench();
+        return 0;
+    }
 
     struct pll_list list;
     pll_list_init(&list);
@@ -381,7 +717,15 @@ int main(int argc, const char **argv)
     }
 
 
-    do_inserts();
+    heap_frag_init(&pll_frag, opts.ruin_heap);
+    heap_frag_init(&ll_frag, opts.ruin_heap);
+
+    if (opts.no_perf)
+        perf_counters_init(&perf);
+    else
+        perf_counters_open(&perf);
+
+    do_inserts(PHASE_INSERTS);
 
     unsigned pll_hash; 
     unsigned ll_hash; 
@@ -389,35 +733,36 @@ int main(int argc, const char **argv)
     puts("checksums 1:");
     do_checksums(&pll_hash, &ll_hash);
 
-    if (opts.ruin_heap){
-        unruin_heap(&pll_hinfo);
-        unruin_heap(&ll_hinfo);
-    }
-
     do_deletes();
 
     puts("checksums 2:");
     do_checksums(&pll_hash, &ll_hash);
 
-    do_inserts();
+    do_inserts(PHASE_REINSERTS);
 
 
     puts("checksums 3:");
     do_checksums(&pll_hash, &ll_hash);
 
     if (opts.enable_pll) {
+        PLL_ASSERT_VALID(pll, &pll_root, 1, PLL_VALIDATE_ALL_REACHABLE);
+        pll_stats.exc_alloc_time = tcounter_seconds(&pll_alloc_counter);
+        pll_stats.n_ruin_heap = pll_frag.n_allocs;
         dump_stats("pool allocated linked list", &pll_stats);
+        dump_pll_list_stats(&list);
         pll_list_deinit(&list);
         pll_root = 0;
     }
     if (opts.enable_ll) {
+        ll_stats.exc_alloc_time = tcounter_seconds(&ll_alloc_counter);
+        ll_stats.n_ruin_heap = ll_frag.n_allocs;
         dump_stats("classic linked list", &ll_stats);
         ll_dealloc();
         ll_root = NULL;
     }
+    perf_counters_close(&perf);
 
-    if (opts.ruin_heap){
-        unruin_heap(&pll_hinfo);
-        unruin_heap(&ll_hinfo);
-    }
+    heap_frag_deinit(&pll_frag);
+    heap_frag_deinit(&ll_frag);
+    allocator_deinit(&ll_alloc);
 }
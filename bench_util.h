@@ -1,3 +1,6 @@
+#include <math.h>
+#include "util.h"
+
 //source https://gist.github.com/kornelski
 static unsigned update_adler32(unsigned adler, const unsigned char* data, unsigned len) {
     unsigned s1 = adler & 0xffff;
@@ -18,3 +21,79 @@ static unsigned update_adler32(unsigned adler, const unsigned char* data, unsign
 
     return (s2 << 16) | s1;
 }
+
+//zipf distributed ranks in [0, n), rank 0 is the most popular, s is the skew (~1 for real traces)
+struct zipf_gen {
+    double *cdf;
+    int n;
+};
+static void zipf_init(struct zipf_gen *z, int n, double s) {
+    z->n = n;
+    z->cdf = xmalloc(n * sizeof(double));
+    double sum = 0;
+    for (int i=0; i<n; i++) {
+        sum += 1.0 / pow(i + 1, s);
+        z->cdf[i] = sum;
+    }
+    for (int i=0; i<n; i++)
+        z->cdf[i] /= sum;
+}
+static void zipf_deinit(struct zipf_gen *z) {
+    xfree(z->cdf);
+    z->cdf = NULL;
+}
+//uses rand(), seed it with srand()
+static int zipf_next(struct zipf_gen *z) {
+    double u = (double)rand() / ((double)RAND_MAX + 1);
+    int lo = 0, hi = z->n - 1;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (z->cdf[mid] < u)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/*
+ *  latency histogram, log2 buckets split into 8 linear sub buckets (<= 12.5% error)
+ *  values below 16 get a bucket each
+ */
+#define LAT_HIST_SUB_BITS 3
+#define LAT_HIST_N_BUCKETS (16 + (64 - 4) * (1 << LAT_HIST_SUB_BITS))
+struct lat_hist {
+    unsigned long count;
+    unsigned long buckets[LAT_HIST_N_BUCKETS];
+};
+static int lat_hist_bucket(unsigned long v) {
+    if (v < 16)
+        return v;
+    int e = 63 - __builtin_clzl(v);
+    int sub = (v >> (e - LAT_HIST_SUB_BITS)) & ((1 << LAT_HIST_SUB_BITS) - 1);
+    return 16 + (e - 4) * (1 << LAT_HIST_SUB_BITS) + sub;
+}
+//largest value that falls into bucket b
+static unsigned long lat_hist_bucket_max(int b) {
+    if (b < 16)
+        return b;
+    int e = (b - 16) / (1 << LAT_HIST_SUB_BITS) + 4;
+    int sub = (b - 16) % (1 << LAT_HIST_SUB_BITS);
+    unsigned long width = 1UL << (e - LAT_HIST_SUB_BITS);
+    return (1UL << e) + sub * width + (width - 1);
+}
+static void lat_hist_add(struct lat_hist *h, unsigned long v) {
+    h->buckets[lat_hist_bucket(v)]++;
+    h->count++;
+}
+//p in [0, 1], returns the upper bound of the bucket holding the percentile (overestimates by < 12.5%)
+static unsigned long lat_hist_percentile(struct lat_hist *h, double p) {
+    unsigned long target = (unsigned long)(p * h->count);
+    unsigned long seen = 0;
+    for (int b=0; b<LAT_HIST_N_BUCKETS; b++) {
+        seen += h->buckets[b];
+        if (seen > target)
+            return lat_hist_bucket_max(b);
+    }
+    return 0;
+}
@@ -0,0 +1,547 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "linkedlist.h"
+#include "plinkedlist.h"
+#include "pll_cursor.h"
+#include "pll_sort.h"
+#include "ll_sort.h"
+#include "pll_validate.h"
+#include "pll_lru.h"
+#include "pll_hashmap.h"
+#include "ll_hashmap.h"
+#include "util.h"
+#include "bench_util.h"
+
+/*
+ *  differential fuzzer: N_LISTS arena lists sharing one pool are driven in lockstep with
+ *  N_LISTS classic lists, after every random operation both sides must have the same lengths
+ *  and checksums and the pool must pass pll_list_validate()
+ *  finally the validator itself is checked against deliberately corrupted pools
+ *  pll_lru is checked against a recency ordered array over several capacities
+ *  and both hash maps against a plain array indexed by key, across their incremental rehashes
+ */
+
+#define N_LISTS 8
+#define MAX_LIST_LEN 512 //keeps the per operation O(n) reference walks cheap
+
+enum op { OP_INSERT, OP_PUSH_FRONT, OP_ERASE, OP_SPLICE, OP_SPLIT, OP_CONCAT,
+          OP_REVERSE, OP_MERGE_SORT, OP_RADIX_SORT, OP_CLEAR, N_OPS };
+static const char *op_names[N_OPS] = {"insert", "push_front", "erase", "splice", "split", "concat",
+                                      "reverse", "merge_sort", "radix_sort", "clear"};
+//relative frequency of every op, inserts dominate so the lists grow
+static const int op_weights[N_OPS] = {40, 15, 12, 8, 2, 3, 3, 2, 2, 1};
+
+static struct opts {
+    int help;
+    int n_iters;
+    int seed;
+    int verbose;
+} opts;
+
+static struct pll_list pool;
+static node_idx pll_roots[N_LISTS];
+static struct ll_node *ll_roots[N_LISTS]; //sentinels, like bench.c's ll_root
+static int ll_lens[N_LISTS];
+static long n_ops[N_OPS];
+
+
+/*classic list reference operations, pos counts from the first node after the sentinel*/
+static struct ll_node *ll_before(int list, int pos) {
+    struct ll_node *node = ll_roots[list];
+    for (int i=0; i<pos; i++)
+        node = node->next;
+    return node;
+}
+static void ll_insert_at(int list, int pos, int value) {
+    struct ll_node *prev = ll_before(list, pos);
+    struct ll_node *node = ll_node_alloc();
+    node->value = value;
+    node->next = prev->next;
+    prev->next = node;
+    ll_lens[list]++;
+}
+static void ll_erase_at(int list, int pos) {
+    struct ll_node *prev = ll_before(list, pos);
+    struct ll_node *victim = prev->next;
+    prev->next = victim->next;
+    ll_node_free(victim);
+    ll_lens[list]--;
+}
+//unlinks [first, last] of src and inserts it before position dst of dst_list (counted after the unlink)
+static void ll_splice(int dst_list, int dst, int src_list, int first, int last) {
+    struct ll_node *prev = ll_before(src_list, first);
+    struct ll_node *range_first = prev->next;
+    struct ll_node *range_last = ll_before(src_list, last + 1);
+    int n = last - first + 1;
+    prev->next = range_last->next;
+    ll_lens[src_list] -= n;
+    struct ll_node *at = ll_before(dst_list, dst);
+    range_last->next = at->next;
+    at->next = range_first;
+    ll_lens[dst_list] += n;
+}
+static void ll_clear(int list) {
+    struct ll_node *head = ll_roots[list]->next;
+    while (head) {
+        struct ll_node *tmp = head->next;
+        ll_node_free(head);
+        head = tmp;
+    }
+    ll_roots[list]->next = NULL;
+    ll_lens[list] = 0;
+}
+static void ll_reverse(int list) {
+    struct ll_node *prev = NULL;
+    struct ll_node *head = ll_roots[list]->next;
+    while (head) {
+        struct ll_node *next = head->next;
+        head->next = prev;
+        prev = head;
+        head = next;
+    }
+    ll_roots[list]->next = prev;
+}
+
+
+static unsigned pll_checksum(int list) {
+    unsigned checksum = 0;
+    for (struct pll_cursor c = pll_cursor_begin(&pool, pll_roots[list]); pll_cursor_valid(&c); pll_cursor_next(&pool, &c))
+        checksum = update_adler32(checksum, (const unsigned char *)&pll_cursor_node(&pool, &c)->value, sizeof(int));
+    return checksum;
+}
+static unsigned ll_checksum(int list) {
+    unsigned checksum = 0;
+    for (struct ll_node *head = ll_roots[list]->next; head; head = head->next)
+        checksum = update_adler32(checksum, (const unsigned char *)&head->value, sizeof(int));
+    return checksum;
+}
+
+static void fail(long iter, enum op op, const char *what) {
+    fprintf(stderr, "fuzz: iteration %ld (op %s, seed %d): %s\n", iter, op_names[op], opts.seed, what);
+    exit(1);
+}
+
+static void check(long iter, enum op op) {
+    const char *err = pll_list_validate(&pool, pll_roots, N_LISTS,
+                                        PLL_VALIDATE_ALL_REACHABLE | PLL_VALIDATE_ARENA_LENGTHS);
+    if (err)
+        fail(iter, op, err);
+    for (int l=0; l<N_LISTS; l++) {
+        if (pll_arena_list_len(&pool, pll_roots[l]) != ll_lens[l])
+            fail(iter, op, "list lengths differ");
+        if (pll_checksum(l) != ll_checksum(l))
+            fail(iter, op, "list checksums differ");
+    }
+}
+
+static enum op random_op() {
+    int total = 0;
+    for (int i=0; i<N_OPS; i++)
+        total += op_weights[i];
+    int r = rand() % total;
+    int op = 0;
+    while (r >= op_weights[op])
+        r -= op_weights[op++];
+    return op;
+}
+
+static void step(long iter) {
+    enum op op = random_op();
+    int a = rand() % N_LISTS;
+    int b = rand() % N_LISTS;
+    int len_a = ll_lens[a];
+    int value = rand() % 1000 - 500; //small range, so sorts see duplicates and negatives
+
+    switch (op) {
+        case OP_INSERT: {
+            if (len_a >= MAX_LIST_LEN)
+                return;
+            int pos = rand() % (len_a + 1);
+            struct pll_cursor c = pll_cursor_at(&pool, pll_roots[a], pos);
+            pll_cursor_insert(&pool, pll_roots[a], &c, value);
+            ll_insert_at(a, pos, value);
+            break;
+        }
+        case OP_PUSH_FRONT:
+            if (len_a >= MAX_LIST_LEN)
+                return;
+            pll_arena_push_front(&pool, pll_roots[a], value);
+            ll_insert_at(a, 0, value);
+            break;
+        case OP_ERASE: {
+            if (!len_a)
+                return;
+            int pos = rand() % len_a;
+            struct pll_cursor c = pll_cursor_at(&pool, pll_roots[a], pos);
+            pll_cursor_erase(&pool, pll_roots[a], &c);
+            ll_erase_at(a, pos);
+            break;
+        }
+        case OP_SPLICE: {
+            if (!len_a)
+                return;
+            int first = rand() % len_a;
+            int last = first + rand() % (len_a - first);
+            int n = last - first + 1;
+            int dst;
+            if (a == b) {
+                //anywhere outside (first, last], counted before the unlink
+                dst = rand() % (len_a - n + 2);
+                if (dst > first)
+                    dst += n - 1;
+            }
+            else {
+                if (ll_lens[b] + n > MAX_LIST_LEN)
+                    return;
+                dst = rand() % (ll_lens[b] + 1);
+            }
+            struct pll_cursor c_first = pll_cursor_at(&pool, pll_roots[a], first);
+            struct pll_cursor c_last = pll_cursor_at(&pool, pll_roots[a], last);
+            struct pll_cursor c_dst = pll_cursor_at(&pool, pll_roots[b], dst);
+            pll_splice(&pool, pll_roots[b], &c_dst, pll_roots[a], &c_first, &c_last);
+            ll_splice(b, (a == b && dst > last) ? dst - n : dst, a, first, last);
+            break;
+        }
+        case OP_SPLIT: {
+            if (a == b)
+                return;
+            int pos = rand() % (len_a + 1);
+            pll_arena_list_free(&pool, pll_roots[b]);
+            struct pll_cursor c = pll_cursor_at(&pool, pll_roots[a], pos);
+            pll_roots[b] = pll_split(&pool, pll_roots[a], &c);
+            ll_clear(b);
+            struct ll_node *prev = ll_before(a, pos);
+            ll_roots[b]->next = prev->next;
+            prev->next = NULL;
+            ll_lens[b] = len_a - pos;
+            ll_lens[a] = pos;
+            break;
+        }
+        case OP_CONCAT:
+            if (a == b || len_a + ll_lens[b] > MAX_LIST_LEN)
+                return;
+            pll_concat(&pool, pll_roots[a], pll_roots[b]);
+            ll_before(a, len_a)->next = ll_roots[b]->next;
+            ll_roots[b]->next = NULL;
+            ll_lens[a] += ll_lens[b];
+            ll_lens[b] = 0;
+            break;
+        case OP_REVERSE:
+            pll_reverse(&pool, pll_roots[a]);
+            ll_reverse(a);
+            break;
+        case OP_MERGE_SORT:
+        case OP_RADIX_SORT: {
+            struct pll_node *root_node = pll_list_get(&pool, pll_roots[a]);
+            if (op == OP_MERGE_SORT)
+                root_node->next = pll_sort_merge(&pool, root_node->next);
+            else
+                root_node->next = pll_sort_radix(&pool, root_node->next);
+            ll_roots[a]->next = ll_sort_merge(ll_roots[a]->next);
+            break;
+        }
+        case OP_CLEAR:
+            pll_arena_list_free(&pool, pll_roots[a]);
+            pll_roots[a] = pll_arena_list_new(&pool);
+            ll_clear(a);
+            break;
+        default:
+            break;
+    }
+    n_ops[op]++;
+    check(iter, op);
+}
+
+
+static void copy_err(char *dst, const char *err) {
+    snprintf(dst, 128, "%s", err ? err : "");
+}
+
+/*every corruption must be reported, and undoing it must make the pool valid again*/
+static void check_validator() {
+    int flags = PLL_VALIDATE_ALL_REACHABLE | PLL_VALIDATE_ARENA_LENGTHS;
+    int l = 0;
+    while (l < N_LISTS - 1 && pll_arena_list_len(&pool, pll_roots[l]) < 2)
+        l++;
+    if (pll_arena_list_len(&pool, pll_roots[l]) < 2) {
+        pll_arena_push_front(&pool, pll_roots[l], 1);
+        pll_arena_push_front(&pool, pll_roots[l], 2);
+    }
+    if (pll_list_validate(&pool, pll_roots, N_LISTS, flags))
+        die("fuzz: validator rejects a valid pool\n");
+
+    struct pll_node *root_node = pll_list_get(&pool, pll_roots[l]);
+    node_idx first = root_node->next;
+    node_idx second = pll_list_get(&pool, first)->next;
+    struct {
+        const char *name;
+        char err[128]; //empty when the corruption was missed
+    } cases[5];
+
+    //cycle in next
+    node_idx saved_next = pll_list_get(&pool, second)->next;
+    pll_list_get(&pool, second)->next = first;
+    cases[0].name = "cycle";
+    copy_err(cases[0].err, pll_list_validate(&pool, pll_roots, N_LISTS, flags));
+    pll_list_get(&pool, second)->next = saved_next;
+
+    //live node whose bit is clear (len kept in sync so only reachability can catch it)
+    bitset_set_bit(&pool.bitset, first, 0);
+    pool.len--;
+    size_t saved_all_1_to = pool.all_1_to;
+    pool.all_1_to = 0;
+    cases[1].name = "clear bit";
+    copy_err(cases[1].err, pll_list_validate(&pool, pll_roots, N_LISTS, flags));
+    bitset_set_bit(&pool.bitset, first, 1);
+    pool.len++;
+    pool.all_1_to = saved_all_1_to;
+
+    //len disagreeing with the bitset
+    pool.len++;
+    cases[2].name = "len";
+    copy_err(cases[2].err, pll_list_validate(&pool, pll_roots, N_LISTS, flags));
+    pool.len--;
+
+    //all_1_to past a free slot
+    long free_slot = bitset_find_false_bit(&pool.bitset, 0);
+    saved_all_1_to = pool.all_1_to;
+    pool.all_1_to = free_slot != -1 ? free_slot + 1 : pool.all_1_to;
+    cases[3].name = "all_1_to";
+    copy_err(cases[3].err, free_slot != -1 && (size_t)free_slot < pool.cap
+        ? pll_list_validate(&pool, pll_roots, N_LISTS, flags) : "skipped, pool is full");
+    pool.all_1_to = saved_all_1_to;
+
+    //arena length off by one
+    root_node->value++;
+    cases[4].name = "arena length";
+    copy_err(cases[4].err, pll_list_validate(&pool, pll_roots, N_LISTS, flags));
+    root_node->value--;
+
+    for (int i=0; i<5; i++) {
+        if (!cases[i].err[0]) {
+            fprintf(stderr, "fuzz: validator missed corruption: %s\n", cases[i].name);
+            exit(1);
+        }
+        if (opts.verbose)
+            printf("\tcaught %-13s %s\n", cases[i].name, cases[i].err);
+    }
+    if (pll_list_validate(&pool, pll_roots, N_LISTS, flags))
+        die("fuzz: pool still invalid after undoing the corruptions\n");
+}
+
+
+/*reference lru: keys/vals ordered from most to least recently used*/
+#define LRU_MAX_CAP 64
+static int ref_keys[LRU_MAX_CAP];
+static int ref_vals[LRU_MAX_CAP];
+static size_t ref_len;
+
+static int ref_find(int key) {
+    for (size_t i=0; i<ref_len; i++) {
+        if (ref_keys[i] == key)
+            return i;
+    }
+    return -1;
+}
+//moves entry i to the front
+static void ref_touch(int i) {
+    int key = ref_keys[i], val = ref_vals[i];
+    memmove(ref_keys + 1, ref_keys, i * sizeof(int));
+    memmove(ref_vals + 1, ref_vals, i * sizeof(int));
+    ref_keys[0] = key;
+    ref_vals[0] = val;
+}
+
+static void lru_fail(size_t cap, long iter, const char *what) {
+    fprintf(stderr, "fuzz: lru capacity %zu, iteration %ld (seed %d): %s\n", cap, iter, opts.seed, what);
+    exit(1);
+}
+
+//walks the recency list both ways and looks every entry up through its hash chain
+static void lru_check(struct pll_lru *lru, long iter, long n_evictions) {
+    size_t cap = lru->capacity;
+    if (pll_lru_len(lru) != ref_len)
+        lru_fail(cap, iter, "lengths differ");
+    if (lru->n_evictions != n_evictions)
+        lru_fail(cap, iter, "eviction counts differ");
+    node_idx idx = lru->head, prev = 0;
+    for (size_t i=0; i<ref_len; i++) {
+        if (!idx || lru->pool.data[idx].value != ref_keys[i] || lru->vals[idx] != ref_vals[i])
+            lru_fail(cap, iter, "recency order differs");
+        if (lru->prev[idx] != prev)
+            lru_fail(cap, iter, "prev link is wrong");
+        if (pll_lru_find(lru, ref_keys[i]) != idx)
+            lru_fail(cap, iter, "hash chain does not lead to the entry");
+        prev = idx;
+        idx = lru->pool.data[idx].next;
+    }
+    if (idx || lru->tail != prev)
+        lru_fail(cap, iter, "list is longer than the reference or tail is wrong");
+}
+
+static void check_lru() {
+    static const size_t caps[] = {1, 2, 3, 16, LRU_MAX_CAP};
+    for (size_t c=0; c<sizeof caps / sizeof *caps; c++) {
+        size_t cap = caps[c];
+        int key_range = cap * 2 + 2; //about half the gets hit
+        long n_evictions = 0;
+        struct pll_lru lru;
+        pll_lru_init(&lru, cap);
+        ref_len = 0;
+        for (long iter=0; iter<opts.n_iters / 4; iter++) {
+            int key = rand() % key_range;
+            int i = ref_find(key);
+            if (rand() % 2) {
+                int val, expected = i != -1 ? ref_vals[i] : 0;
+                bool hit = pll_lru_get(&lru, key, &val);
+                if (hit != (i != -1) || (hit && val != expected))
+                    lru_fail(cap, iter, "get disagrees with the reference");
+                if (i != -1)
+                    ref_touch(i);
+            }
+            else {
+                int val = rand();
+                pll_lru_put(&lru, key, val);
+                if (i == -1) {
+                    if (ref_len == cap) {
+                        ref_len--; //the least recently used one goes
+                        n_evictions++;
+                    }
+                    i = ref_len++;
+                    ref_keys[i] = key;
+                }
+                ref_vals[i] = val;
+                ref_touch(i);
+            }
+            lru_check(&lru, iter, n_evictions);
+        }
+        if (opts.verbose)
+            printf("	lru capacity %-3zu hits %ld, misses %ld, evictions %ld\n",
+                   cap, lru.n_hits, lru.n_misses, lru.n_evictions);
+        pll_lru_deinit(&lru);
+    }
+}
+
+
+/*reference map: ref_present[key] says whether key is mapped, to ref_map_vals[key]*/
+#define MAP_KEY_RANGE (1 << 14) //the maps double several times on the way up
+static bool ref_present[MAP_KEY_RANGE];
+static int ref_map_vals[MAP_KEY_RANGE];
+static size_t ref_map_len;
+
+static void map_fail(long iter, const char *what) {
+    fprintf(stderr, "fuzz: hash maps, iteration %ld (seed %d): %s\n", iter, opts.seed, what);
+    exit(1);
+}
+
+static void map_check_key(struct pll_hashmap *pmap, struct ll_hashmap *lmap, long iter, int key) {
+    int pval = 0, lval = 0;
+    bool phit = pll_hashmap_get(pmap, key, &pval);
+    bool lhit = ll_hashmap_get(lmap, key, &lval);
+    if (phit != ref_present[key] || (phit && pval != ref_map_vals[key]))
+        map_fail(iter, "pll_hashmap get disagrees with the reference");
+    if (lhit != ref_present[key] || (lhit && lval != ref_map_vals[key]))
+        map_fail(iter, "ll_hashmap get disagrees with the reference");
+}
+
+static void check_maps() {
+    struct pll_hashmap pmap;
+    struct ll_hashmap lmap;
+    pll_hashmap_init(&pmap, 0);
+    ll_hashmap_init(&lmap, 0);
+    memset(ref_present, 0, sizeof ref_present);
+    ref_map_len = 0;
+    long n_rehash_removes = 0; //removes that ran while a migration was in progress
+    for (long iter=0; iter<opts.n_iters; iter++) {
+        int key = rand() % MAP_KEY_RANGE;
+        int r = rand() % 8;
+        if (r < 4) { //puts dominate so the maps keep growing
+            int val = rand();
+            pll_hashmap_put(&pmap, key, val);
+            ll_hashmap_put(&lmap, key, val);
+            ref_map_len += !ref_present[key];
+            ref_present[key] = true;
+            ref_map_vals[key] = val;
+        }
+        else if (r < 6) {
+            n_rehash_removes += pmap.rehash_idx != -1;
+            bool premoved = pll_hashmap_remove(&pmap, key);
+            bool lremoved = ll_hashmap_remove(&lmap, key);
+            if (premoved != ref_present[key] || lremoved != ref_present[key])
+                map_fail(iter, "remove disagrees with the reference");
+            ref_map_len -= ref_present[key];
+            ref_present[key] = false;
+        }
+        else {
+            map_check_key(&pmap, &lmap, iter, key);
+        }
+        if (pmap.len != ref_map_len || lmap.len != ref_map_len)
+            map_fail(iter, "lengths differ");
+        if (iter % 4096 == 0) {
+            for (int k=0; k<MAP_KEY_RANGE; k++)
+                map_check_key(&pmap, &lmap, iter, k);
+        }
+    }
+    for (int k=0; k<MAP_KEY_RANGE; k++)
+        map_check_key(&pmap, &lmap, opts.n_iters, k);
+    if (opts.verbose)
+        printf("	maps len %zu, buckets %zu, removes during a rehash %ld\n",
+               ref_map_len, pmap.n_buckets[0], n_rehash_removes);
+    pll_hashmap_deinit(&pmap);
+    ll_hashmap_deinit(&lmap);
+}
+
+
+void parse_argv(int argc, const char **argv)
+{
+    argv_get_int(argc, argv, "-n", &opts.n_iters, 100000);
+    argv_get_int(argc, argv, "--seed", &opts.seed, 1);
+    if (argv_get_int(argc, argv, "-h", &opts.help, 0)) opts.help = 1;
+    if (argv_get_int(argc, argv, "-v", &opts.verbose, 0)) opts.verbose = 1;
+    if (opts.help) {
+        printf(
+        "Options:\n"
+        "\t-n\tnumber of random operations, a quarter of that per lru capacity (default: 100000)\n"
+        "\t--seed\tsrand() seed, failures report it so they can be replayed (default: 1)\n"
+        "\t-v\tprint operation counts and the corruptions the validator caught\n"
+        ); //printf
+        exit(0);
+    }
+    printf("fuzz\tn_iters: %d, seed: %d\n", opts.n_iters, opts.seed);
+}
+
+int main(int argc, const char **argv)
+{
+    parse_argv(argc, argv);
+    srand(opts.seed);
+
+    pll_list_init(&pool);
+    for (int l=0; l<N_LISTS; l++) {
+        pll_roots[l] = pll_arena_list_new(&pool);
+        ll_roots[l] = ll_node_alloc();
+        ll_roots[l]->value = 0;
+        ll_roots[l]->next = NULL;
+        ll_lens[l] = 0;
+    }
+
+    for (long i=0; i<opts.n_iters; i++)
+        step(i);
+    check_validator();
+    check_lru();
+    check_maps();
+
+    if (opts.verbose) {
+        for (int op=0; op<N_OPS; op++)
+            printf("\t%-11s %ld\n", op_names[op], n_ops[op]);
+    }
+    struct pll_list_stats ls;
+    pll_list_stats(&pool, &ls, 1);
+    printf("ok\tlive nodes: %zu, cap: %zu\n", ls.n_live, ls.cap);
+
+    for (int l=0; l<N_LISTS; l++) {
+        pll_arena_list_free(&pool, pll_roots[l]);
+        ll_clear(l);
+        ll_node_free(ll_roots[l]);
+    }
+    pll_list_deinit(&pool);
+}
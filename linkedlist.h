@@ -3,6 +3,7 @@
 #include <stdint.h>
 #include <string.h>
 #include "util.h"
+#include "alloc.h"
 
 struct ll_node {
     int value;
@@ -11,12 +12,12 @@ struct ll_node {
 
 static struct ll_node* ll_node_alloc() 
 {
-    return xmalloc(sizeof(struct ll_node));
+    return ll_allocator->alloc(ll_allocator->ctx, sizeof(struct ll_node));
 }
 
 static void ll_node_free(struct ll_node *node)
 {
-    xfree(node);
+    ll_allocator->free(ll_allocator->ctx, node, sizeof(struct ll_node));
 }
 
 #endif /* LINKEDLIST_H */
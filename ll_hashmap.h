@@ -0,0 +1,167 @@
+#ifndef LL_HASHMAP_H
+#define LL_HASHMAP_H
+#include "linkedlist.h"
+
+/*
+ *  classic chained hash map, every entry is allocated through ll_allocator and chained with pointers
+ *  same incremental rehashing scheme as pll_hashmap, used as its baseline in bench.c
+ */
+
+#define LL_HASHMAP_REHASH_STEP 1
+
+struct ll_map_node {
+    int key;
+    int value;
+    struct ll_map_node *next;
+};
+
+struct ll_hashmap {
+    struct ll_map_node **buckets[2];
+    size_t n_buckets[2];
+    long rehash_idx;
+    size_t len;
+};
+
+static struct ll_map_node **ll_hashmap_buckets_new(size_t n_buckets)
+{
+    struct ll_map_node **buckets = xmalloc(n_buckets * sizeof(struct ll_map_node *));
+    memset(buckets, 0, n_buckets * sizeof(struct ll_map_node *));
+    return buckets;
+}
+
+static void ll_hashmap_init(struct ll_hashmap *map, size_t n_buckets)
+{
+    size_t n = 16;
+    while (n < n_buckets)
+        n *= 2;
+    map->buckets[0] = ll_hashmap_buckets_new(n);
+    map->n_buckets[0] = n;
+    map->buckets[1] = NULL;
+    map->n_buckets[1] = 0;
+    map->rehash_idx = -1;
+    map->len = 0;
+}
+
+static void ll_hashmap_deinit(struct ll_hashmap *map)
+{
+    for (int t=0; t<2; t++) {
+        for (size_t b=0; b<map->n_buckets[t]; b++) {
+            struct ll_map_node *head = map->buckets[t][b];
+            while (head) {
+                struct ll_map_node *tmp = head->next;
+                ll_allocator->free(ll_allocator->ctx, head, sizeof(struct ll_map_node));
+                head = tmp;
+            }
+        }
+        xfree(map->buckets[t]);
+    }
+    memset(map, 0, sizeof *map);
+}
+
+static size_t ll_hashmap_bucket(struct ll_hashmap *map, int table, int key)
+{
+    return hash_u32((unsigned)key) & (map->n_buckets[table] - 1);
+}
+
+static void ll_hashmap_rehash_step(struct ll_hashmap *map)
+{
+    int n_steps = LL_HASHMAP_REHASH_STEP;
+    int n_empty_visits = LL_HASHMAP_REHASH_STEP * 10;
+    while (n_steps && map->rehash_idx < (long)map->n_buckets[0]) {
+        struct ll_map_node *head = map->buckets[0][map->rehash_idx];
+        if (!head) {
+            map->rehash_idx++;
+            if (!--n_empty_visits)
+                break;
+            continue;
+        }
+        while (head) {
+            struct ll_map_node *next = head->next;
+            size_t b = ll_hashmap_bucket(map, 1, head->key);
+            head->next = map->buckets[1][b];
+            map->buckets[1][b] = head;
+            head = next;
+        }
+        map->buckets[0][map->rehash_idx++] = NULL;
+        n_steps--;
+    }
+    if (map->rehash_idx == (long)map->n_buckets[0]) {
+        xfree(map->buckets[0]);
+        map->buckets[0] = map->buckets[1];
+        map->n_buckets[0] = map->n_buckets[1];
+        map->buckets[1] = NULL;
+        map->n_buckets[1] = 0;
+        map->rehash_idx = -1;
+    }
+}
+
+static void ll_hashmap_maybe_grow(struct ll_hashmap *map)
+{
+    if (map->rehash_idx != -1 || map->len < map->n_buckets[0])
+        return;
+    map->n_buckets[1] = map->n_buckets[0] * 2;
+    map->buckets[1] = ll_hashmap_buckets_new(map->n_buckets[1]);
+    map->rehash_idx = 0;
+}
+
+//returns the link pointing at the node holding key (so it can be unlinked), or NULL
+static struct ll_map_node **ll_hashmap_find(struct ll_hashmap *map, int key)
+{
+    int n_tables = map->rehash_idx == -1 ? 1 : 2;
+    for (int t=0; t<n_tables; t++) {
+        struct ll_map_node **link = &map->buckets[t][ll_hashmap_bucket(map, t, key)];
+        while (*link) {
+            if ((*link)->key == key)
+                return link;
+            link = &(*link)->next;
+        }
+    }
+    return NULL;
+}
+
+static bool ll_hashmap_get(struct ll_hashmap *map, int key, int *out_val)
+{
+    if (map->rehash_idx != -1)
+        ll_hashmap_rehash_step(map);
+    struct ll_map_node **link = ll_hashmap_find(map, key);
+    if (!link)
+        return false;
+    *out_val = (*link)->value;
+    return true;
+}
+
+static void ll_hashmap_put(struct ll_hashmap *map, int key, int value)
+{
+    if (map->rehash_idx != -1)
+        ll_hashmap_rehash_step(map);
+    struct ll_map_node **link = ll_hashmap_find(map, key);
+    if (link) {
+        (*link)->value = value;
+        return;
+    }
+    ll_hashmap_maybe_grow(map);
+    int t = map->rehash_idx == -1 ? 0 : 1;
+    size_t b = ll_hashmap_bucket(map, t, key);
+    struct ll_map_node *node = ll_allocator->alloc(ll_allocator->ctx, sizeof(struct ll_map_node));
+    node->key = key;
+    node->value = value;
+    node->next = map->buckets[t][b];
+    map->buckets[t][b] = node;
+    map->len++;
+}
+
+static bool ll_hashmap_remove(struct ll_hashmap *map, int key)
+{
+    if (map->rehash_idx != -1)
+        ll_hashmap_rehash_step(map);
+    struct ll_map_node **link = ll_hashmap_find(map, key);
+    if (!link)
+        return false;
+    struct ll_map_node *node = *link;
+    *link = node->next;
+    ll_allocator->free(ll_allocator->ctx, node, sizeof(struct ll_map_node));
+    map->len--;
+    return true;
+}
+
+#endif /* LL_HASHMAP_H */
@@ -0,0 +1,49 @@
+#ifndef LL_SORT_H
+#define LL_SORT_H
+#include "linkedlist.h"
+
+//bottom-up merge sort, stable, O(1) extra space, same algorithm as pll_sort_merge
+static struct ll_node *ll_sort_merge(struct ll_node *head)
+{
+    if (!head)
+        return NULL;
+    for (size_t run = 1;; run *= 2) {
+        struct ll_node *p = head;
+        struct ll_node *tail = NULL;
+        size_t n_merges = 0;
+        head = NULL;
+        while (p) {
+            struct ll_node *q = p;
+            size_t p_len = 0;
+            size_t q_len = run;
+            n_merges++;
+            while (q && p_len < run) {
+                p_len++;
+                q = q->next;
+            }
+            while (p_len || (q_len && q)) {
+                struct ll_node *e;
+                if (!p_len) {
+                    e = q; q = q->next; q_len--;
+                }
+                else if (!q_len || !q || p->value <= q->value) {
+                    e = p; p = p->next; p_len--;
+                }
+                else {
+                    e = q; q = q->next; q_len--;
+                }
+                if (tail)
+                    tail->next = e;
+                else
+                    head = e;
+                tail = e;
+            }
+            p = q;
+        }
+        tail->next = NULL;
+        if (n_merges <= 1)
+            return head;
+    }
+}
+
+#endif /* LL_SORT_H */
@@ -0,0 +1,137 @@
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include "perf_counters.h"
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+static const char *event_names[PERF_N_EVENTS] = {
+    "instructions",
+    "l1d_misses",
+    "llc_misses",
+    "dtlb_misses",
+    "branch_misses",
+};
+
+void perf_counters_init(struct perf_counters *pc)
+{
+    for (int i=0; i<PERF_N_EVENTS; i++)
+        pc->fds[i] = -1;
+}
+
+const char *perf_event_name(enum perf_event_kind kind)
+{
+    return event_names[kind];
+}
+
+#ifdef __linux__
+#define CACHE_READ_MISS(cache) \
+    ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static int open_event(uint32_t type, uint64_t config)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof attr);
+    attr.size = sizeof attr;
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0); //this thread, any cpu
+}
+
+void perf_counters_open(struct perf_counters *pc)
+{
+    perf_counters_init(pc);
+    pc->fds[PERF_INSTRUCTIONS]  = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    pc->fds[PERF_L1D_MISSES]    = open_event(PERF_TYPE_HW_CACHE, CACHE_READ_MISS(PERF_COUNT_HW_CACHE_L1D));
+    pc->fds[PERF_LLC_MISSES]    = open_event(PERF_TYPE_HW_CACHE, CACHE_READ_MISS(PERF_COUNT_HW_CACHE_LL));
+    pc->fds[PERF_DTLB_MISSES]   = open_event(PERF_TYPE_HW_CACHE, CACHE_READ_MISS(PERF_COUNT_HW_CACHE_DTLB));
+    pc->fds[PERF_BRANCH_MISSES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+}
+
+//value, time_enabled, time_running, the times are never reset so intervals have to be diffed
+static bool read_event(int fd, uint64_t buf[3])
+{
+    return read(fd, buf, 3 * sizeof *buf) == 3 * sizeof *buf;
+}
+
+void perf_counters_start(struct perf_counters *pc)
+{
+    for (int i=0; i<PERF_N_EVENTS; i++) {
+        if (pc->fds[i] == -1)
+            continue;
+        if (!read_event(pc->fds[i], pc->started[i]))
+            memset(pc->started[i], 0, sizeof pc->started[i]);
+        ioctl(pc->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+void perf_counters_stop(struct perf_counters *pc, struct perf_sample *out)
+{
+    for (int i=0; i<PERF_N_EVENTS; i++) {
+        if (pc->fds[i] == -1)
+            continue;
+        ioctl(pc->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+    }
+    for (int i=0; i<PERF_N_EVENTS; i++) {
+        uint64_t buf[3];
+        if (pc->fds[i] == -1)
+            continue;
+        if (!read_event(pc->fds[i], buf)) {
+            out->missed[i] = true;
+            continue;
+        }
+        uint64_t value   = buf[0] - pc->started[i][0];
+        uint64_t enabled = buf[1] - pc->started[i][1];
+        uint64_t running = buf[2] - pc->started[i][2];
+        if (!running) { //never got a hardware counter during this interval, nothing to scale
+            out->missed[i] = true;
+            continue;
+        }
+        if (running < enabled)
+            value = (uint64_t)((double)value * enabled / running);
+        out->values[i] += value;
+    }
+}
+#else
+void perf_counters_open(struct perf_counters *pc)
+{
+    perf_counters_init(pc);
+}
+void perf_counters_start(struct perf_counters *pc) {}
+void perf_counters_stop(struct perf_counters *pc, struct perf_sample *out)
+{
+    for (int i=0; i<PERF_N_EVENTS; i++)
+        out->missed[i] = true;
+}
+#endif
+
+void perf_counters_close(struct perf_counters *pc)
+{
+    for (int i=0; i<PERF_N_EVENTS; i++) {
+        if (pc->fds[i] != -1)
+            close(pc->fds[i]);
+        pc->fds[i] = -1;
+    }
+}
+
+bool perf_counters_available(struct perf_counters *pc, enum perf_event_kind kind)
+{
+    return pc->fds[kind] != -1;
+}
+
+bool perf_counters_any_available(struct perf_counters *pc)
+{
+    for (int i=0; i<PERF_N_EVENTS; i++) {
+        if (pc->fds[i] != -1)
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,48 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ *  hardware performance counters (linux perf_event_open), counting this thread in user space
+ *  every event is opened on its own, events the kernel/cpu/container refuses are skipped,
+ *  on other platforms nothing is available
+ */
+
+enum perf_event_kind {
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_DTLB_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_N_EVENTS,
+};
+
+struct perf_counters {
+    int fds[PERF_N_EVENTS]; //-1 when unavailable
+    uint64_t started[PERF_N_EVENTS][3]; //value, time_enabled, time_running at perf_counters_start()
+};
+
+/*
+ *  accumulated counts, multiplexed counters are scaled up to the time they were enabled
+ *  an event that was never scheduled during one of the intervals has no estimate, it is marked missed
+ */
+struct perf_sample {
+    long long values[PERF_N_EVENTS];
+    bool missed[PERF_N_EVENTS];
+};
+
+/*marks every counter unavailable, perf_counters_open() starts with this*/
+void perf_counters_init(struct perf_counters *pc);
+void perf_counters_open(struct perf_counters *pc);
+void perf_counters_close(struct perf_counters *pc);
+bool perf_counters_available(struct perf_counters *pc, enum perf_event_kind kind);
+bool perf_counters_any_available(struct perf_counters *pc);
+/*snapshots and enables every available counter*/
+void perf_counters_start(struct perf_counters *pc);
+/*disables every available counter and adds the counts since perf_counters_start() to out, scaled by
+  the enabled/running time of that interval*/
+void perf_counters_stop(struct perf_counters *pc, struct perf_sample *out);
+const char *perf_event_name(enum perf_event_kind kind);
+
+#endif /*PERF_COUNTERS_H*/
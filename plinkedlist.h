@@ -21,10 +21,11 @@ struct pll_list {
     size_t all_1_to;
 };
 
-static void pll_list_init(struct pll_list *list)
+//cap is the number of slots to reserve upfront (including null), it still grows on demand
+static void pll_list_init_cap(struct pll_list *list, size_t cap)
 {
     list->len = 1; //because of null
-    list->cap = 16;
+    list->cap = cap < 16 ? 16 : cap;
     list->data = xmalloc(list->cap * sizeof(struct pll_node));
 
     list->all_1_to = 0;
@@ -32,6 +33,11 @@ static void pll_list_init(struct pll_list *list)
     bitset_set_bit(&list->bitset, 0, 1); // set our null as occupied
 }
 
+static void pll_list_init(struct pll_list *list)
+{
+    pll_list_init_cap(list, 16);
+}
+
 static void pll_list_deinit(struct pll_list *list)
 {
     bitset_deinit(&list->bitset);
@@ -69,4 +75,122 @@ static struct pll_node *pll_list_get(struct pll_list *list, node_idx idx)
     assert(idx != 0);
     return list->data + idx;
 }
+
+/*
+ *  pool health, null is not counted as a live node
+ *
+ *  density: live nodes / slots up to the highest live one, low density means
+ *           holes that a compaction (or a smaller cap) could give back
+ *  avg_link_distance: mean |idx - next| over sampled live nodes that have a next,
+ *           1 is a perfectly sequential layout
+ */
+struct pll_list_stats {
+    size_t n_live;
+    size_t cap;
+    long highest_live; //0 when there are no live nodes
+    double occupancy;  //n_live / usable slots
+    double density;
+    double avg_link_distance;
+    size_t n_link_samples;
+    size_t data_bytes;
+    size_t bitset_bytes;
+};
+
+//O(cap / 32) for the counts plus O(cap / sample_every) for the link distance
+static void pll_list_stats(struct pll_list *list, struct pll_list_stats *out, size_t sample_every)
+{
+    if (!sample_every)
+        sample_every = 1;
+    out->n_live = bitset_popcount(&list->bitset) - 1;
+    out->cap = list->cap;
+    out->highest_live = bitset_find_last_true_bit(&list->bitset);
+    out->occupancy = (double)out->n_live / (list->cap - 1);
+    out->density = out->highest_live > 0 ? (double)out->n_live / out->highest_live : 1.0;
+
+    double distance_sum = 0;
+    out->n_link_samples = 0;
+    for (size_t i = 1; i <= (size_t)out->highest_live; i += sample_every) {
+        node_idx next = list->data[i].next;
+        if (!next || !bitset_get_bit(&list->bitset, i))
+            continue;
+        distance_sum += next > (node_idx)i ? next - (node_idx)i : (node_idx)i - next;
+        out->n_link_samples++;
+    }
+    out->avg_link_distance = out->n_link_samples ? distance_sum / out->n_link_samples : 0;
+
+    out->data_bytes = list->cap * sizeof(struct pll_node);
+    out->bitset_bytes = bitset_bytes(&list->bitset);
+}
+
+/*
+ *  multi-list arena
+ *
+ *  many independent lists can share one pll_list pool, a list is identified by its root:
+ *  a header node whose value holds the list length and whose next is the first element.
+ *
+ *  root -> a -> b -> 0
+ *  (len: 2)
+ */
+static node_idx pll_arena_list_new(struct pll_list *list)
+{
+    node_idx root = pll_node_alloc(list);
+    struct pll_node *root_node = pll_list_get(list, root);
+    root_node->value = 0;
+    root_node->next = 0; //'null', empty list
+    return root;
+}
+
+static int pll_arena_list_len(struct pll_list *list, node_idx root)
+{
+    return pll_list_get(list, root)->value;
+}
+
+/*
+ *  at  ->  at.next
+ *
+ *  at  -> value -> at.next
+ *
+ *  'at' is either the root or a node of the list owned by root
+ *  returns the node_idx of the newly created node
+ */
+static node_idx pll_arena_insert(struct pll_list *list, node_idx root, node_idx at, int value)
+{
+    node_idx new_idx = pll_node_alloc(list); //may move list->data, get pointers after it
+    struct pll_node *at_node = pll_list_get(list, at);
+    struct pll_node *new_node = pll_list_get(list, new_idx);
+    new_node->value = value;
+    new_node->next = at_node->next;
+    at_node->next = new_idx;
+    pll_list_get(list, root)->value++;
+    return new_idx;
+}
+
+static node_idx pll_arena_push_front(struct pll_list *list, node_idx root, int value)
+{
+    return pll_arena_insert(list, root, root, value);
+}
+
+//unlinks and frees the node after 'at', returns false if 'at' is the tail
+static bool pll_arena_remove_after(struct pll_list *list, node_idx root, node_idx at)
+{
+    struct pll_node *at_node = pll_list_get(list, at);
+    node_idx victim = at_node->next;
+    if (!victim)
+        return false;
+    at_node->next = pll_list_get(list, victim)->next;
+    pll_node_free(list, victim);
+    pll_list_get(list, root)->value--;
+    return true;
+}
+
+//frees every node of the list and the root itself, the root index is invalid afterwards
+static void pll_arena_list_free(struct pll_list *list, node_idx root)
+{
+    node_idx head = root;
+    while (head) {
+        node_idx next = pll_list_get(list, head)->next;
+        pll_node_free(list, head);
+        head = next;
+    }
+}
 #endif /* POOL_LINKEDLIST_H */
@@ -0,0 +1,149 @@
+#ifndef PLL_CURSOR_H
+#define PLL_CURSOR_H
+#include "plinkedlist.h"
+
+/*
+ *  cursors and range operations over arena lists (see pll_arena_list_new())
+ *
+ *  root -> a -> b -> c -> 0
+ *          ^    ^
+ *        prev  cur      (pos: 1)
+ *
+ *  a cursor remembers the node before it, so inserting/erasing/splicing at it is O(1),
+ *  and its position, so range lengths are known without walking them
+ *  any operation that changes links invalidates other cursors on the lists involved,
+ *  unless stated otherwise
+ */
+
+struct pll_cursor {
+    node_idx prev; //the root when at the first node
+    node_idx cur;  //0 when past the end
+    int pos;
+};
+
+static struct pll_cursor pll_cursor_begin(struct pll_list *list, node_idx root)
+{
+    struct pll_cursor c;
+    c.prev = root;
+    c.cur = pll_list_get(list, root)->next;
+    c.pos = 0;
+    return c;
+}
+
+static bool pll_cursor_valid(struct pll_cursor *c)
+{
+    return c->cur != 0;
+}
+
+static void pll_cursor_next(struct pll_list *list, struct pll_cursor *c)
+{
+    assert(c->cur);
+    c->prev = c->cur;
+    c->cur = pll_list_get(list, c->cur)->next;
+    c->pos++;
+}
+
+static struct pll_node *pll_cursor_node(struct pll_list *list, struct pll_cursor *c)
+{
+    return pll_list_get(list, c->cur);
+}
+
+//O(pos), pos may equal the length to get the end cursor
+static struct pll_cursor pll_cursor_at(struct pll_list *list, node_idx root, int pos)
+{
+    assert(pos >= 0 && pos <= pll_arena_list_len(list, root));
+    struct pll_cursor c = pll_cursor_begin(list, root);
+    while (c.pos < pos)
+        pll_cursor_next(list, &c);
+    return c;
+}
+
+//inserts before the cursor, which stays at the same node (its pos moves up by one)
+static node_idx pll_cursor_insert(struct pll_list *list, node_idx root, struct pll_cursor *c, int value)
+{
+    node_idx new_idx = pll_arena_insert(list, root, c->prev, value);
+    c->prev = new_idx;
+    c->pos++;
+    return new_idx;
+}
+
+//erases the node at the cursor, which moves to the following node
+static void pll_cursor_erase(struct pll_list *list, node_idx root, struct pll_cursor *c)
+{
+    assert(c->cur);
+    node_idx next = pll_list_get(list, c->cur)->next;
+    pll_arena_remove_after(list, root, c->prev);
+    c->cur = next;
+}
+
+/*
+ *  moves the nodes [first, last] of src before dst, O(1)
+ *
+ *  src: ... first.prev -> [first ... last] -> last.next ...
+ *  dst: ... dst.prev -> dst.cur ...
+ *
+ *  src and dst may be the same list as long as dst is not inside (first, last]
+ *  no node is allocated, freed or has its value touched
+ */
+static void pll_splice(struct pll_list *list, node_idx dst_root, struct pll_cursor *dst,
+                       node_idx src_root, struct pll_cursor *first, struct pll_cursor *last)
+{
+    assert(first->cur && last->cur && first->pos <= last->pos);
+    assert(dst_root != src_root || dst->pos <= first->pos || dst->pos > last->pos);
+    if (dst->prev == first->prev || dst->prev == last->cur)
+        return; //the range is already at dst
+    int n = last->pos - first->pos + 1;
+    struct pll_node *last_node = pll_list_get(list, last->cur);
+
+    pll_list_get(list, first->prev)->next = last_node->next;
+    pll_list_get(list, dst->prev)->next = first->cur;
+    last_node->next = dst->cur;
+
+    pll_list_get(list, src_root)->value -= n;
+    pll_list_get(list, dst_root)->value += n;
+}
+
+//moves [c, end) into a new list and returns its root, O(1)
+static node_idx pll_split(struct pll_list *list, node_idx root, struct pll_cursor *c)
+{
+    node_idx new_root = pll_arena_list_new(list); //may move list->data, get pointers after it
+    struct pll_node *root_node = pll_list_get(list, root);
+    struct pll_node *new_root_node = pll_list_get(list, new_root);
+    new_root_node->next = c->cur;
+    new_root_node->value = root_node->value - c->pos;
+    root_node->value = c->pos;
+    pll_list_get(list, c->prev)->next = 0;
+    return new_root;
+}
+
+//appends every node of src to dst, src is left empty, O(length of dst)
+//dst and src must be different lists, appending a list to itself would make it a cycle
+static void pll_concat(struct pll_list *list, node_idx dst_root, node_idx src_root)
+{
+    assert(dst_root != src_root);
+    struct pll_node *src_root_node = pll_list_get(list, src_root);
+    node_idx tail = dst_root;
+    while (pll_list_get(list, tail)->next)
+        tail = pll_list_get(list, tail)->next;
+    pll_list_get(list, tail)->next = src_root_node->next;
+    pll_list_get(list, dst_root)->value += src_root_node->value;
+    src_root_node->next = 0;
+    src_root_node->value = 0;
+}
+
+static void pll_reverse(struct pll_list *list, node_idx root)
+{
+    struct pll_node *root_node = pll_list_get(list, root);
+    node_idx prev = 0;
+    node_idx head = root_node->next;
+    while (head) {
+        struct pll_node *node = pll_list_get(list, head);
+        node_idx next = node->next;
+        node->next = prev;
+        prev = head;
+        head = next;
+    }
+    root_node->next = prev;
+}
+
+#endif /* PLL_CURSOR_H */
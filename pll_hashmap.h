@@ -0,0 +1,191 @@
+#ifndef PLL_HASHMAP_H
+#define PLL_HASHMAP_H
+#include "plinkedlist.h"
+
+/*
+ *  chained hash map whose collision chains are pll_list nodes
+ *
+ *  buckets: [ idx ] [ 0 ] [ idx ] ...
+ *              |             |
+ *             key -> key     key -> 0
+ *
+ *  a node's value is the key, the mapped value lives in vals[node_idx]
+ *  resizing is incremental: while rehashing, every operation moves a few buckets
+ *  from table 0 to table 1, lookups check both tables, inserts go to table 1
+ */
+
+#define PLL_HASHMAP_REHASH_STEP 1 //non empty buckets migrated per operation
+
+struct pll_hashmap {
+    struct pll_list pool;
+    int *vals;
+    size_t vals_cap;
+    node_idx *buckets[2];
+    size_t n_buckets[2]; //always a power of 2
+    long rehash_idx; //next bucket of table 0 to migrate, -1 when not rehashing
+    size_t len;
+};
+
+static node_idx *pll_hashmap_buckets_new(size_t n_buckets)
+{
+    node_idx *buckets = xmalloc(n_buckets * sizeof(node_idx));
+    memset(buckets, 0, n_buckets * sizeof(node_idx));
+    return buckets;
+}
+
+//n_buckets is rounded up to a power of 2
+static void pll_hashmap_init(struct pll_hashmap *map, size_t n_buckets)
+{
+    size_t n = 16;
+    while (n < n_buckets)
+        n *= 2;
+    pll_list_init_cap(&map->pool, n);
+    map->vals_cap = map->pool.cap;
+    map->vals = xmalloc(map->vals_cap * sizeof(int));
+    map->buckets[0] = pll_hashmap_buckets_new(n);
+    map->n_buckets[0] = n;
+    map->buckets[1] = NULL;
+    map->n_buckets[1] = 0;
+    map->rehash_idx = -1;
+    map->len = 0;
+}
+
+static void pll_hashmap_deinit(struct pll_hashmap *map)
+{
+    pll_list_deinit(&map->pool);
+    xfree(map->vals);
+    xfree(map->buckets[0]);
+    xfree(map->buckets[1]);
+    memset(map, 0, sizeof *map);
+}
+
+static size_t pll_hashmap_bucket(struct pll_hashmap *map, int table, int key)
+{
+    return hash_u32((unsigned)key) & (map->n_buckets[table] - 1);
+}
+
+//moves up to PLL_HASHMAP_REHASH_STEP non empty buckets (visiting at most 10x as many empty ones)
+static void pll_hashmap_rehash_step(struct pll_hashmap *map)
+{
+    int n_steps = PLL_HASHMAP_REHASH_STEP;
+    int n_empty_visits = PLL_HASHMAP_REHASH_STEP * 10;
+    while (n_steps && map->rehash_idx < (long)map->n_buckets[0]) {
+        node_idx head = map->buckets[0][map->rehash_idx];
+        if (!head) {
+            map->rehash_idx++;
+            if (!--n_empty_visits)
+                break;
+            continue;
+        }
+        while (head) {
+            struct pll_node *node = pll_list_get(&map->pool, head);
+            node_idx next = node->next;
+            size_t b = pll_hashmap_bucket(map, 1, node->value);
+            node->next = map->buckets[1][b];
+            map->buckets[1][b] = head;
+            head = next;
+        }
+        map->buckets[0][map->rehash_idx++] = 0;
+        n_steps--;
+    }
+    if (map->rehash_idx == (long)map->n_buckets[0]) {
+        xfree(map->buckets[0]);
+        map->buckets[0] = map->buckets[1];
+        map->n_buckets[0] = map->n_buckets[1];
+        map->buckets[1] = NULL;
+        map->n_buckets[1] = 0;
+        map->rehash_idx = -1;
+    }
+}
+
+static void pll_hashmap_maybe_grow(struct pll_hashmap *map)
+{
+    if (map->rehash_idx != -1 || map->len < map->n_buckets[0])
+        return; //load factor is still below 1, or already growing
+    map->n_buckets[1] = map->n_buckets[0] * 2;
+    map->buckets[1] = pll_hashmap_buckets_new(map->n_buckets[1]);
+    map->rehash_idx = 0;
+}
+
+//returns the node holding key, or 0, optionally reporting the table/bucket/predecessor it was found at
+static node_idx pll_hashmap_find(struct pll_hashmap *map, int key, int *out_table, size_t *out_bucket, node_idx *out_prev)
+{
+    int n_tables = map->rehash_idx == -1 ? 1 : 2;
+    for (int t=0; t<n_tables; t++) {
+        size_t b = pll_hashmap_bucket(map, t, key);
+        node_idx prev = 0;
+        node_idx head = map->buckets[t][b];
+        while (head) {
+            struct pll_node *node = pll_list_get(&map->pool, head);
+            if (node->value == key) {
+                if (out_table)  *out_table = t;
+                if (out_bucket) *out_bucket = b;
+                if (out_prev)   *out_prev = prev;
+                return head;
+            }
+            prev = head;
+            head = node->next;
+        }
+    }
+    return 0;
+}
+
+static bool pll_hashmap_get(struct pll_hashmap *map, int key, int *out_val)
+{
+    if (map->rehash_idx != -1)
+        pll_hashmap_rehash_step(map);
+    node_idx idx = pll_hashmap_find(map, key, NULL, NULL, NULL);
+    if (!idx)
+        return false;
+    *out_val = map->vals[idx];
+    return true;
+}
+
+//inserts key or overwrites its value if it already exists
+static void pll_hashmap_put(struct pll_hashmap *map, int key, int value)
+{
+    if (map->rehash_idx != -1)
+        pll_hashmap_rehash_step(map);
+    node_idx idx = pll_hashmap_find(map, key, NULL, NULL, NULL);
+    if (idx) {
+        map->vals[idx] = value;
+        return;
+    }
+    pll_hashmap_maybe_grow(map);
+    int t = map->rehash_idx == -1 ? 0 : 1;
+    size_t b = pll_hashmap_bucket(map, t, key);
+
+    idx = pll_node_alloc(&map->pool);
+    if (map->pool.cap > map->vals_cap) {
+        map->vals_cap = map->pool.cap;
+        map->vals = xrealloc(map->vals, map->vals_cap * sizeof(int));
+    }
+    struct pll_node *node = pll_list_get(&map->pool, idx);
+    node->value = key;
+    node->next = map->buckets[t][b];
+    map->buckets[t][b] = idx;
+    map->vals[idx] = value;
+    map->len++;
+}
+
+static bool pll_hashmap_remove(struct pll_hashmap *map, int key)
+{
+    if (map->rehash_idx != -1)
+        pll_hashmap_rehash_step(map);
+    int t;
+    size_t b;
+    node_idx prev;
+    node_idx idx = pll_hashmap_find(map, key, &t, &b, &prev);
+    if (!idx)
+        return false;
+    node_idx next = pll_list_get(&map->pool, idx)->next;
+    if (prev)
+        pll_list_get(&map->pool, prev)->next = next;
+    else
+        map->buckets[t][b] = next;
+    pll_node_free(&map->pool, idx);
+    map->len--;
+    return true;
+}
+
+#endif /* PLL_HASHMAP_H */
@@ -0,0 +1,154 @@
+#ifndef PLL_LRU_H
+#define PLL_LRU_H
+#include "plinkedlist.h"
+
+/*
+ *  fixed budget LRU cache stored in a pll_list pool
+ *
+ *  head (most recent) <-> ... <-> tail (least recent, evicted first)
+ *
+ *  a node's value is the key and its next links towards the tail,
+ *  prev/hnext/vals are parallel arrays indexed by node_idx:
+ *  prev links towards the head and hnext chains the nodes of a hash bucket
+ *  everything is allocated by pll_lru_init(), get/put/evict never allocate
+ */
+
+struct pll_lru {
+    struct pll_list pool;
+    node_idx *prev;
+    node_idx *hnext;
+    int *vals;
+    node_idx *buckets;
+    size_t n_buckets; //power of 2
+    node_idx head;
+    node_idx tail;
+    size_t capacity;
+    long n_hits;
+    long n_misses;
+    long n_evictions;
+};
+
+static void pll_lru_init(struct pll_lru *lru, size_t capacity)
+{
+    assert(capacity > 0);
+    //+1 for null, the pool never fills up since we evict before allocating
+    pll_list_init_cap(&lru->pool, capacity + 1);
+    size_t cap = lru->pool.cap;
+    lru->prev  = xmalloc(cap * sizeof(node_idx));
+    lru->hnext = xmalloc(cap * sizeof(node_idx));
+    lru->vals  = xmalloc(cap * sizeof(int));
+    lru->n_buckets = 16;
+    while (lru->n_buckets < capacity)
+        lru->n_buckets *= 2;
+    lru->buckets = xmalloc(lru->n_buckets * sizeof(node_idx));
+    memset(lru->buckets, 0, lru->n_buckets * sizeof(node_idx));
+    lru->head = lru->tail = 0;
+    lru->capacity = capacity;
+    lru->n_hits = lru->n_misses = lru->n_evictions = 0;
+}
+
+static void pll_lru_deinit(struct pll_lru *lru)
+{
+    pll_list_deinit(&lru->pool);
+    xfree(lru->prev);
+    xfree(lru->hnext);
+    xfree(lru->vals);
+    xfree(lru->buckets);
+    memset(lru, 0, sizeof *lru);
+}
+
+static size_t pll_lru_len(struct pll_lru *lru)
+{
+    return lru->pool.len - 1; //because of null
+}
+
+static node_idx *pll_lru_bucket(struct pll_lru *lru, int key)
+{
+    return lru->buckets + (hash_u32((unsigned)key) & (lru->n_buckets - 1));
+}
+
+static node_idx pll_lru_find(struct pll_lru *lru, int key)
+{
+    node_idx idx = *pll_lru_bucket(lru, key);
+    while (idx && lru->pool.data[idx].value != key)
+        idx = lru->hnext[idx];
+    return idx;
+}
+
+static void pll_lru_unlink(struct pll_lru *lru, node_idx idx)
+{
+    node_idx prev = lru->prev[idx];
+    node_idx next = lru->pool.data[idx].next;
+    if (prev) lru->pool.data[prev].next = next;
+    else      lru->head = next;
+    if (next) lru->prev[next] = prev;
+    else      lru->tail = prev;
+}
+
+static void pll_lru_link_front(struct pll_lru *lru, node_idx idx)
+{
+    lru->prev[idx] = 0;
+    lru->pool.data[idx].next = lru->head;
+    if (lru->head) lru->prev[lru->head] = idx;
+    else           lru->tail = idx;
+    lru->head = idx;
+}
+
+//drops the least recently used entry, returns false if the cache is empty
+static bool pll_lru_evict(struct pll_lru *lru)
+{
+    node_idx victim = lru->tail;
+    if (!victim)
+        return false;
+    pll_lru_unlink(lru, victim);
+    node_idx *link = pll_lru_bucket(lru, lru->pool.data[victim].value);
+    while (*link != victim)
+        link = lru->hnext + *link;
+    *link = lru->hnext[victim];
+    pll_node_free(&lru->pool, victim);
+    lru->n_evictions++;
+    return true;
+}
+
+//on a hit the entry becomes the most recently used one
+static bool pll_lru_get(struct pll_lru *lru, int key, int *out_val)
+{
+    node_idx idx = pll_lru_find(lru, key);
+    if (!idx) {
+        lru->n_misses++;
+        return false;
+    }
+    lru->n_hits++;
+    if (idx != lru->head) {
+        pll_lru_unlink(lru, idx);
+        pll_lru_link_front(lru, idx);
+    }
+    *out_val = lru->vals[idx];
+    return true;
+}
+
+//inserts or updates key as the most recently used entry, evicting the tail when full
+static void pll_lru_put(struct pll_lru *lru, int key, int value)
+{
+    node_idx idx = pll_lru_find(lru, key);
+    if (idx) {
+        lru->vals[idx] = value;
+        if (idx != lru->head) {
+            pll_lru_unlink(lru, idx);
+            pll_lru_link_front(lru, idx);
+        }
+        return;
+    }
+    if (pll_lru_len(lru) == lru->capacity)
+        pll_lru_evict(lru);
+    idx = pll_node_alloc(&lru->pool);
+    assert(idx < (node_idx)lru->pool.cap);
+    lru->pool.data[idx].value = key;
+    lru->vals[idx] = value;
+    node_idx *bucket = pll_lru_bucket(lru, key);
+    lru->hnext[idx] = *bucket;
+    *bucket = idx;
+    pll_lru_link_front(lru, idx);
+}
+
+#endif /* PLL_LRU_H */
@@ -0,0 +1,118 @@
+#ifndef PLL_SORT_H
+#define PLL_SORT_H
+#include "plinkedlist.h"
+
+/*
+ *  sorting a chain of pll_nodes in ascending value order
+ *  both functions take the first node of the chain and return the new first node,
+ *  the caller relinks it to whatever pointed at the old one (a root for example)
+ */
+
+/*
+ *  bottom-up merge sort, stable, O(1) extra space
+ *  only the next indices change, every node keeps its slot and value
+ */
+static node_idx pll_sort_merge(struct pll_list *list, node_idx head)
+{
+    struct pll_node *data = list->data;
+    if (!head)
+        return 0;
+    for (size_t run = 1;; run *= 2) {
+        node_idx p = head;
+        node_idx tail = 0;
+        size_t n_merges = 0;
+        head = 0;
+        while (p) {
+            //[p .. p_len) and [q .. q_len) are the two runs being merged
+            node_idx q = p;
+            size_t p_len = 0;
+            size_t q_len = run;
+            n_merges++;
+            while (q && p_len < run) {
+                p_len++;
+                q = data[q].next;
+            }
+            while (p_len || (q_len && q)) {
+                node_idx e;
+                if (!p_len) {
+                    e = q; q = data[q].next; q_len--;
+                }
+                else if (!q_len || !q || data[p].value <= data[q].value) {
+                    e = p; p = data[p].next; p_len--;
+                }
+                else {
+                    e = q; q = data[q].next; q_len--;
+                }
+                if (tail)
+                    data[tail].next = e;
+                else
+                    head = e;
+                tail = e;
+            }
+            p = q;
+        }
+        data[tail].next = 0;
+        if (n_merges <= 1)
+            return head;
+    }
+}
+
+//lsd radix sort, 4 passes of 8 bits, the result ends up back in keys
+static void pll_radix_sort_u32(unsigned *keys, unsigned *tmp, size_t n)
+{
+    for (int shift = 0; shift < 32; shift += 8) {
+        size_t count[257] = {0};
+        for (size_t i=0; i<n; i++)
+            count[((keys[i] >> shift) & 0xFF) + 1]++;
+        for (int b=0; b<256; b++)
+            count[b + 1] += count[b];
+        for (size_t i=0; i<n; i++)
+            tmp[count[(keys[i] >> shift) & 0xFF]++] = keys[i];
+        unsigned *swap = keys;
+        keys = tmp;
+        tmp = swap;
+    }
+    //an even number of passes leaves the result in the original keys buffer
+}
+
+/*
+ *  radix sort + relayout, O(n) extra space
+ *  the values are extracted in one walk and radix sorted, the slots the chain occupies are
+ *  sorted too, then the sorted values are written back slot by slot so that the chain is
+ *  traversed in ascending slot order, a chain that owns a dense range of slots ends up
+ *  perfectly sequential
+ *  values move between slots, so node indices held elsewhere no longer refer to the same value
+ */
+static node_idx pll_sort_radix(struct pll_list *list, node_idx head)
+{
+    size_t n = 0;
+    for (node_idx i = head; i; i = list->data[i].next)
+        n++;
+    if (n < 2)
+        return head;
+
+    unsigned *vals  = xmalloc(n * sizeof(unsigned));
+    unsigned *slots = xmalloc(n * sizeof(unsigned));
+    unsigned *tmp   = xmalloc(n * sizeof(unsigned));
+    size_t k = 0;
+    for (node_idx i = head; i; i = list->data[i].next) {
+        vals[k] = (unsigned)list->data[i].value ^ 0x80000000U; //flip the sign bit so negatives sort first
+        slots[k] = i;
+        k++;
+    }
+    pll_radix_sort_u32(vals, tmp, n);
+    pll_radix_sort_u32(slots, tmp, n);
+
+    for (k=0; k<n; k++) {
+        struct pll_node *node = list->data + slots[k];
+        node->value = (int)(vals[k] ^ 0x80000000U);
+        node->next = k + 1 < n ? (node_idx)slots[k + 1] : 0;
+    }
+    head = slots[0];
+    xfree(vals);
+    xfree(slots);
+    xfree(tmp);
+    return head;
+}
+
+#endif /* PLL_SORT_H */
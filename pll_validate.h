@@ -0,0 +1,101 @@
+#ifndef PLL_VALIDATE_H
+#define PLL_VALIDATE_H
+#include <stdio.h>
+#include "plinkedlist.h"
+
+/*
+ *  consistency checker for a pll_list pool, one linear pass over the bitset and the given lists
+ *
+ *  always checked:
+ *      null (slot 0) is occupied, cap/bit_len/len agree, popcount of the bitset == len,
+ *      every slot below all_1_to is occupied (the allocator skips them)
+ *  for every root given:
+ *      the root and every node reachable from it is live, next is within cap,
+ *      no cycles and no node shared between two lists
+ *  flags:
+ *      PLL_VALIDATE_ALL_REACHABLE: the roots own the whole pool, every live node must be reached
+ *      PLL_VALIDATE_ARENA_LENGTHS: the roots are arena roots, their value must match their length
+ *
+ *  returns NULL when the pool is consistent or a description of the first violation found
+ *  (stored in a static buffer, overwritten by the next call)
+ */
+#define PLL_VALIDATE_ALL_REACHABLE 1
+#define PLL_VALIDATE_ARENA_LENGTHS 2
+
+static const char *pll_list_validate(struct pll_list *list, const node_idx *roots, size_t n_roots, int flags)
+{
+    static char err[128];
+    struct bitset *bits = &list->bitset;
+    const char *msg = NULL;
+    long bad = 0;
+
+    if (list->cap != bits->bit_len || list->len > list->cap || !list->len)
+        return "cap, bitset length and len disagree";
+    if (!bitset_get_bit(bits, 0))
+        return "null (slot 0) is not marked as occupied";
+    if (bitset_popcount(bits) != list->len)
+        return "bitset popcount does not match len";
+    long first_free = bitset_find_false_bit(bits, 0);
+    if (first_free != -1 && (size_t)first_free < list->all_1_to) {
+        snprintf(err, sizeof err, "slot %ld is free but below all_1_to (%zu)", first_free, list->all_1_to);
+        return err;
+    }
+    if (!n_roots)
+        return NULL;
+
+    //a node is visited once, meeting it again means a cycle or two lists sharing it
+    struct bitset visited;
+    bitset_init(&visited, list->cap);
+    size_t n_visited = 0;
+    for (size_t r=0; r<n_roots && !msg; r++) {
+        node_idx head = roots[r];
+        long length = -1; //the root itself is not counted
+        while (head) {
+            if (head < 0 || (size_t)head >= list->cap) {
+                msg = "next is out of range";
+                bad = head;
+                break;
+            }
+            if (!bitset_get_bit(bits, head)) {
+                msg = "reachable node is not marked as occupied";
+                bad = head;
+                break;
+            }
+            if (bitset_get_bit(&visited, head)) {
+                msg = "node reached twice (cycle or shared between lists)";
+                bad = head;
+                break;
+            }
+            bitset_set_bit(&visited, head, 1);
+            n_visited++;
+            length++;
+            head = list->data[head].next;
+        }
+        if (!msg && (flags & PLL_VALIDATE_ARENA_LENGTHS) && list->data[roots[r]].value != length) {
+            msg = "arena root length does not match the nodes reached from it";
+            bad = roots[r];
+        }
+    }
+    bitset_deinit(&visited);
+    if (!msg && (flags & PLL_VALIDATE_ALL_REACHABLE) && n_visited != list->len - 1)
+        return "some live nodes are not reachable from any root";
+    if (!msg)
+        return NULL;
+    snprintf(err, sizeof err, "%s (node %ld)", msg, bad);
+    return err;
+}
+
+/*checks only in debug builds, dies with the violation found*/
+#ifndef NDEBUG
+#define PLL_ASSERT_VALID(list, roots, n_roots, flags) do { \
+        const char *pll_err_ = pll_list_validate(list, roots, n_roots, flags); \
+        if (pll_err_) { \
+            fprintf(stderr, "%s:%d: pll_list invalid: %s\n", __FILE__, __LINE__, pll_err_); \
+            abort(); \
+        } \
+    } while (0)
+#else
+#define PLL_ASSERT_VALID(list, roots, n_roots, flags) ((void)0)
+#endif
+
+#endif /* PLL_VALIDATE_H */
@@ -0,0 +1,387 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "linkedlist.h"
+#include "plinkedlist.h"
+#include "util.h"
+#include "bench_util.h"
+#include "timer.h"
+#include "alloc.h"
+
+/*
+ *  benchmark suite: runs both list variants over a matrix of
+ *  list size x insert/delete mix x access pattern x heap fragmentation level
+ *
+ *  every run builds a list of n pinned nodes (negative values, never deleted) at random positions,
+ *  then performs n_ops operations, each one picks a pinned node by the access pattern and either
+ *  inserts after it or deletes the (unpinned) node after it, every operation is timed individually
+ *  finally the list is traversed once computing the same checksum bench.c uses
+ *
+ *  the p50/p99/p999 latencies are histogram bucket upper bounds, at most 12.5% above the true value
+ */
+
+enum pattern { PATTERN_SEQ, PATTERN_RANDOM, PATTERN_ZIPF, N_PATTERNS };
+static const char *pattern_names[N_PATTERNS] = {"seq", "random", "zipf"};
+
+#define N_SIZES 4
+static const char *size_names[N_SIZES] = {"L1", "L2", "LLC", "10xLLC"};
+#define N_MIXES 3
+static const int mix_insert_pct[N_MIXES] = {100, 90, 50};
+#define N_FRAG_LEVELS 3 //heap_frag level, 0: none
+
+enum output { OUTPUT_TEXT, OUTPUT_CSV, OUTPUT_JSON };
+
+static struct opts {
+    int help;
+    int n_ops;
+    int enable_ll;
+    int enable_pll;
+    int max_size;
+    int max_nodes;
+    int allocator;
+    int csv;
+    int json;
+} opts;
+
+struct workload {
+    int size;
+    size_t n_nodes;
+    bool clamped; //n_nodes was cut down (--max-nodes or memory), the list is smaller than the size name says
+    int insert_pct;
+    int pattern;
+    int frag;
+};
+
+struct result {
+    long n_inserts;
+    long n_deletes;
+    unsigned checksum;
+    double build_time;
+    double ops_time;
+    double traverse_time;
+    struct lat_hist hist;
+};
+
+static struct timer_info tinfo;
+static struct allocator ll_alloc; //recreated for every classic list run
+
+
+/*picks which pinned node the i'th operation targets*/
+static struct zipf_gen zipf;
+static size_t pick(struct workload *w, int i) {
+    switch (w->pattern) {
+        case PATTERN_SEQ:    return i % w->n_nodes;
+        case PATTERN_RANDOM: return rand() % w->n_nodes;
+        default:             return zipf_next(&zipf);
+    }
+}
+
+
+static node_idx pll_insert(struct pll_list *list, node_idx at, int value) {
+    node_idx tail = pll_node_alloc(list);
+    struct pll_node *at_node = pll_list_get(list, at);
+    struct pll_node *tail_node = pll_list_get(list, tail);
+    tail_node->next = at_node->next;
+    tail_node->value = value;
+    at_node->next = tail;
+    return tail;
+}
+static struct ll_node *ll_insert(struct ll_node *node, int value) {
+    struct ll_node *tail_node = ll_node_alloc();
+    tail_node->next = node->next;
+    tail_node->value = value;
+    node->next = tail_node;
+    return tail_node;
+}
+
+static void pll_run(struct workload *w, struct result *r) {
+    struct pll_list list;
+    struct heap_frag frag;
+    heap_frag_init(&frag, w->frag);
+    pll_list_init(&list);
+    node_idx root = pll_node_alloc(&list);
+    pll_list_get(&list, root)->value = 0;
+    pll_list_get(&list, root)->next = 0;
+    node_idx *pinned = xmalloc(w->n_nodes * sizeof(node_idx));
+
+    srand(0xBEEF);
+    timer_begin(&tinfo);
+    for (size_t i=0; i<w->n_nodes; i++) {
+        node_idx at = i ? pinned[rand() % i] : root;
+        pinned[i] = pll_insert(&list, at, -(int)(i + 1));
+        heap_frag_step(&frag);
+    }
+    r->build_time = timer_dt(&tinfo);
+
+    srand(0xFEED);
+    double ns_per_cycle = 1.0e9 / cycles_per_sec();
+    timer_begin(&tinfo);
+    for (int i=0; i<opts.n_ops; i++) {
+        node_idx at = pinned[pick(w, i)];
+        bool insert = rand() % 100 < w->insert_pct;
+        uint64_t op_start = cycles_now();
+        if (insert) {
+            pll_insert(&list, at, i);
+            r->n_inserts++;
+        }
+        else {
+            struct pll_node *at_node = pll_list_get(&list, at);
+            node_idx next = at_node->next;
+            if (next && pll_list_get(&list, next)->value >= 0) {
+                at_node->next = pll_list_get(&list, next)->next;
+                pll_node_free(&list, next);
+                r->n_deletes++;
+            }
+        }
+        lat_hist_add(&r->hist, (cycles_now() - op_start) * ns_per_cycle);
+    }
+    r->ops_time = timer_dt(&tinfo);
+
+    timer_begin(&tinfo);
+    for (node_idx head = root; head; head = pll_list_get(&list, head)->next)
+        r->checksum = update_adler32(r->checksum, (const unsigned char *)&pll_list_get(&list, head)->value, sizeof(int));
+    r->traverse_time = timer_dt(&tinfo);
+
+    xfree(pinned);
+    heap_frag_deinit(&frag);
+    pll_list_deinit(&list);
+}
+
+static void ll_run(struct workload *w, struct result *r) {
+    allocator_init(&ll_alloc, opts.allocator);
+    ll_allocator = &ll_alloc;
+    struct heap_frag frag;
+    heap_frag_init(&frag, w->frag);
+    struct ll_node *root = ll_node_alloc();
+    root->value = 0;
+    root->next = NULL;
+    struct ll_node **pinned = xmalloc(w->n_nodes * sizeof(struct ll_node *));
+
+    srand(0xBEEF);
+    timer_begin(&tinfo);
+    for (size_t i=0; i<w->n_nodes; i++) {
+        struct ll_node *at = i ? pinned[rand() % i] : root;
+        pinned[i] = ll_insert(at, -(int)(i + 1));
+        heap_frag_step(&frag);
+    }
+    r->build_time = timer_dt(&tinfo);
+
+    srand(0xFEED);
+    double ns_per_cycle = 1.0e9 / cycles_per_sec();
+    timer_begin(&tinfo);
+    for (int i=0; i<opts.n_ops; i++) {
+        struct ll_node *at = pinned[pick(w, i)];
+        bool insert = rand() % 100 < w->insert_pct;
+        uint64_t op_start = cycles_now();
+        if (insert) {
+            ll_insert(at, i);
+            r->n_inserts++;
+        }
+        else {
+            struct ll_node *next = at->next;
+            if (next && next->value >= 0) {
+                at->next = next->next;
+                ll_node_free(next);
+                r->n_deletes++;
+            }
+        }
+        lat_hist_add(&r->hist, (cycles_now() - op_start) * ns_per_cycle);
+    }
+    r->ops_time = timer_dt(&tinfo);
+
+    timer_begin(&tinfo);
+    for (struct ll_node *head = root; head; head = head->next)
+        r->checksum = update_adler32(r->checksum, (const unsigned char *)&head->value, sizeof(int));
+    r->traverse_time = timer_dt(&tinfo);
+
+    while (root) {
+        struct ll_node *tmp = root->next;
+        ll_node_free(root);
+        root = tmp;
+    }
+    xfree(pinned);
+    heap_frag_deinit(&frag);
+    allocator_deinit(&ll_alloc);
+}
+
+
+static enum output output_mode() {
+    return opts.json ? OUTPUT_JSON : opts.csv ? OUTPUT_CSV : OUTPUT_TEXT;
+}
+
+static void print_header() {
+    switch (output_mode()) {
+        case OUTPUT_CSV:
+            puts("impl,size,n_nodes,bytes,clamped,insert_pct,pattern,frag,allocator,n_ops,n_inserts,n_deletes,"
+                 "build_time,ops_time,traverse_time,ops_per_sec,p50_ns,p99_ns,p999_ns,checksum");
+            break;
+        case OUTPUT_JSON:
+            puts("[");
+            break;
+        case OUTPUT_TEXT:
+            printf("%-4s %-7s %9s %4s %4s %-7s %4s %10s %8s %8s %8s %9s %12s\n",
+                   "impl", "size", "n_nodes", "clmp", "ins%", "pattern", "frag",
+                   "ops/s", "p50_ns", "p99_ns", "p999_ns", "traverse", "checksum");
+            break;
+    }
+}
+
+//node_bytes and alloc_name describe the implementation being reported, pll nodes come from its own pool
+static void print_result(const char *impl, size_t node_bytes, const char *alloc_name,
+                         struct workload *w, struct result *r, bool first) {
+    double ops_per_sec = opts.n_ops / r->ops_time;
+    unsigned long p50  = lat_hist_percentile(&r->hist, 0.5);
+    unsigned long p99  = lat_hist_percentile(&r->hist, 0.99);
+    unsigned long p999 = lat_hist_percentile(&r->hist, 0.999);
+    switch (output_mode()) {
+        case OUTPUT_CSV:
+            printf("%s,%s,%zu,%zu,%d,%d,%s,%d,%s,%d,%ld,%ld,%.6f,%.6f,%.6f,%.0f,%lu,%lu,%lu,%u\n",
+                   impl, size_names[w->size], w->n_nodes, w->n_nodes * node_bytes, w->clamped,
+                   w->insert_pct, pattern_names[w->pattern], w->frag, alloc_name, opts.n_ops, r->n_inserts, r->n_deletes, r->build_time, r->ops_time, r->traverse_time,
+                   ops_per_sec, p50, p99, p999, r->checksum);
+            break;
+        case OUTPUT_JSON:
+            printf("%s{\"impl\": \"%s\", \"size\": \"%s\", \"n_nodes\": %zu, \"bytes\": %zu, \"clamped\": %s, \"insert_pct\": %d, "
+                   "\"pattern\": \"%s\", \"frag\": %d, \"allocator\": \"%s\", \"n_ops\": %d, \"n_inserts\": %ld, \"n_deletes\": %ld, "
+                   "\"build_time\": %.6f, \"ops_time\": %.6f, \"traverse_time\": %.6f, \"ops_per_sec\": %.0f, "
+                   "\"p50_ns\": %lu, \"p99_ns\": %lu, \"p999_ns\": %lu, \"checksum\": %u}",
+                   first ? "  " : ",\n  ",
+                   impl, size_names[w->size], w->n_nodes, w->n_nodes * node_bytes,
+                   w->clamped ? "true" : "false",
+                   w->insert_pct, pattern_names[w->pattern], w->frag, alloc_name, opts.n_ops, r->n_inserts, r->n_deletes, r->build_time, r->ops_time, r->traverse_time,
+                   ops_per_sec, p50, p99, p999, r->checksum);
+            break;
+        case OUTPUT_TEXT:
+            printf("%-4s %-7s %9zu %4s %4d %-7s %4d %10.0f %8lu %8lu %8lu %9.4f %12u\n",
+                   impl, size_names[w->size], w->n_nodes, w->clamped ? "yes" : "no", w->insert_pct, pattern_names[w->pattern], w->frag,
+                   ops_per_sec, p50, p99, p999, r->traverse_time, r->checksum);
+            break;
+    }
+    fflush(stdout);
+}
+
+static void print_footer() {
+    if (output_mode() == OUTPUT_JSON)
+        puts("\n]");
+}
+
+
+//list sizes in bytes of classic nodes, sysconf() reports 0 on some systems so fall back to common sizes
+static size_t size_bytes(int size) {
+    long l1 = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+    long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    long llc = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if (l1 <= 0)  l1 = 32 * 1024;
+    if (l2 <= 0)  l2 = 1024 * 1024;
+    if (llc <= 0) llc = 8 * 1024 * 1024;
+    switch (size) {
+        case 0:  return l1;
+        case 1:  return l2;
+        case 2:  return llc;
+        default: return llc * 10;
+    }
+}
+
+//nodes that fit in half the physical memory, 64 bytes a node covers the node itself, malloc overhead,
+//the pinned array and the pool doubling on growth
+static size_t mem_max_nodes() {
+    long pages = sysconf(_SC_PHYS_PAGES);
+    long page_size = sysconf(_SC_PAGESIZE);
+    if (pages <= 0 || page_size <= 0)
+        return (size_t)-1;
+    return (size_t)pages * page_size / 2 / 64;
+}
+
+void parse_argv(int argc, const char **argv)
+{
+    argv_get_int(argc, argv, "-n", &opts.n_ops, 200000);
+    if (argv_get_int(argc, argv, "-h", &opts.help, 0)) opts.help = 1;
+    if (argv_get_int(argc, argv, "--enable-pll", &opts.enable_pll, 0)) opts.enable_pll = 1;
+    if (argv_get_int(argc, argv, "--enable-ll", &opts.enable_ll,  0)) opts.enable_ll = 1;
+    //1 based, argv_get_int() can't tell an explicit 0 from a missing value so it falls back to -1
+    if (!argv_get_int(argc, argv, "--max-size", &opts.max_size, -1))
+        opts.max_size = N_SIZES;
+    argv_get_int(argc, argv, "--allocator", &opts.allocator, ALLOCATOR_SYSTEM);
+    argv_get_int(argc, argv, "--max-nodes", &opts.max_nodes, 0);
+    if (argv_get_int(argc, argv, "--csv", &opts.csv, 0)) opts.csv = 1;
+    if (argv_get_int(argc, argv, "--json", &opts.json, 0)) opts.json = 1;
+    if (opts.help) {
+        printf(
+        "Options:\n"
+        "\t-n\tnumber of timed operations per run (default: 200000)\n"
+        "\t--enable-ll\tenable classic linked list\n"
+        "\t--enable-pll\tenable pool allocated linked list\n"
+        "\t--max-size\tlargest list size to run, 1: L1, 2: L2, 3: LLC, 4: 10x LLC (default: 4)\n"
+        "\t--max-nodes\tclamp every list size to this many nodes (default: no clamp), sizes that don't fit\n"
+        "\t\tin half the physical memory are always clamped, clamped runs are flagged in the output\n"
+        "\t\tand sizes that collapse onto the previous one are skipped\n"
+        "\t--allocator\tallocator behind the classic list nodes, 0: system, 1: bump, 2: slab (default: 0)\n"
+        "\t--csv\toutput one csv row per run\n"
+        "\t--json\toutput a json array with one object per run\n"
+        ); //printf
+        exit(0);
+    }
+    if (!opts.enable_ll && !opts.enable_pll) {
+        opts.enable_ll = opts.enable_pll = 1;
+    }
+    if (opts.allocator < 0 || opts.allocator >= N_ALLOCATORS)
+        die("unknown --allocator\n");
+    if (opts.max_size < 1 || opts.max_size > N_SIZES)
+        die("--max-size must be between 1 and 4\n");
+}
+
+int main(int argc, const char **argv)
+{
+    parse_argv(argc, argv);
+    allocator_init(&ll_alloc, opts.allocator); //for its name
+    allocator_deinit(&ll_alloc);
+    print_header();
+    bool first = true;
+    struct result *r = xmalloc(sizeof *r);
+    size_t prev_n_nodes = 0;
+    for (int size=0; size<opts.max_size; size++) {
+        struct workload w;
+        w.size = size;
+        size_t wanted = size_bytes(size) / sizeof(struct ll_node);
+        w.n_nodes = wanted;
+        if (opts.max_nodes > 0 && w.n_nodes > (size_t)opts.max_nodes) {
+            fprintf(stderr, "suite: %s (%zu nodes) clamped to --max-nodes %d\n",
+                    size_names[size], w.n_nodes, opts.max_nodes);
+            w.n_nodes = opts.max_nodes;
+        }
+        if (w.n_nodes > mem_max_nodes()) {
+            //some systems report huge shared LLCs, 10x of them doesn't fit
+            fprintf(stderr, "suite: %s (%zu nodes) clamped to %zu nodes to fit in memory\n",
+                    size_names[size], w.n_nodes, mem_max_nodes());
+            w.n_nodes = mem_max_nodes();
+        }
+        w.clamped = w.n_nodes < wanted;
+        if (w.n_nodes == prev_n_nodes) {
+            fprintf(stderr, "suite: skipping %s, it is the same list size as the previous one\n", size_names[size]);
+            continue;
+        }
+        prev_n_nodes = w.n_nodes;
+        zipf_init(&zipf, w.n_nodes, 0.99);
+        for (int mix=0; mix<N_MIXES; mix++) {
+            w.insert_pct = mix_insert_pct[mix];
+            for (w.pattern=0; w.pattern<N_PATTERNS; w.pattern++) {
+                for (w.frag=0; w.frag<N_FRAG_LEVELS; w.frag++) {
+                    if (opts.enable_pll) {
+                        memset(r, 0, sizeof *r);
+                        pll_run(&w, r);
+                        print_result("pll", sizeof(struct pll_node), "pool", &w, r, first);
+                        first = false;
+                    }
+                    if (opts.enable_ll) {
+                        memset(r, 0, sizeof *r);
+                        ll_run(&w, r);
+                        print_result("ll", sizeof(struct ll_node), ll_alloc.name, &w, r, first);
+                        first = false;
+                    }
+                }
+            }
+        }
+        zipf_deinit(&zipf);
+    }
+    print_footer();
+    xfree(r);
+}
@@ -1,8 +1,11 @@
 #include "plinkedlist.h"
+#include "pll_sort.h"
+#include "pll_cursor.h"
 #include <stdio.h>
 
 struct opts {
     int n_rand;
+    int n_lists;
 } opts;
 
 void pll_iter_nodes(struct pll_list *list, node_idx root) {
@@ -14,6 +17,13 @@ void pll_iter_nodes(struct pll_list *list, node_idx root) {
     }
 }
 
+void pll_print_list(struct pll_list *list, node_idx root) {
+    printf("list %d (len: %d):", (int)root, pll_arena_list_len(list, root));
+    for (struct pll_cursor c = pll_cursor_begin(list, root); pll_cursor_valid(&c); pll_cursor_next(list, &c))
+        printf(" %d", pll_cursor_node(list, &c)->value);
+    printf("\n");
+}
+
 
 /*
  *  at  ->  at.next
@@ -70,7 +80,72 @@ int main(int argc, const char **argv)
         }
         puts("iterating randomly inserted nodes:");
         pll_iter_nodes(&list, root);
+
+        struct pll_node *root_node = pll_list_get(&list, root);
+        root_node->next = pll_sort_merge(&list, root_node->next);
+        puts("iterating merge sorted nodes:");
+        pll_iter_nodes(&list, root);
+
+        root_node->next = pll_sort_radix(&list, root_node->next);
+        puts("iterating radix sorted (relayed out) nodes:");
+        pll_iter_nodes(&list, root);
     }
 
     pll_list_deinit(&list); //this deallocates everything
+
+    //many lists sharing a single pool
+    argv_get_int(argc, argv, "--lists", &opts.n_lists, 3);
+    struct pll_list arena;
+    pll_list_init_cap(&arena, opts.n_lists * 4);
+    node_idx *roots = xmalloc(opts.n_lists * sizeof(node_idx));
+    for (int i=0; i<opts.n_lists; i++) {
+        roots[i] = pll_arena_list_new(&arena);
+        for (int j=0; j<=i; j++)
+            pll_arena_push_front(&arena, roots[i], i * 10 + j);
+    }
+    pll_arena_remove_after(&arena, roots[opts.n_lists - 1], roots[opts.n_lists - 1]);
+    puts("iterating arena lists:");
+    for (int i=0; i<opts.n_lists; i++)
+        pll_print_list(&arena, roots[i]);
+
+    //range operations
+    node_idx a = pll_arena_list_new(&arena);
+    node_idx b = pll_arena_list_new(&arena);
+    struct pll_cursor c = pll_cursor_begin(&arena, a);
+    for (int i=0; i<8; i++)
+        pll_cursor_insert(&arena, a, &c, i);
+    for (int i=0; i<3; i++)
+        pll_arena_push_front(&arena, b, 100 + i);
+    puts("range operations:");
+    pll_print_list(&arena, a);
+    pll_print_list(&arena, b);
+
+    struct pll_cursor first = pll_cursor_at(&arena, a, 2);
+    struct pll_cursor last = pll_cursor_at(&arena, a, 4);
+    struct pll_cursor dst = pll_cursor_at(&arena, b, 1);
+    puts("splice a[2..4] before b[1]:");
+    pll_splice(&arena, b, &dst, a, &first, &last);
+    pll_print_list(&arena, a);
+    pll_print_list(&arena, b);
+
+    struct pll_cursor at = pll_cursor_at(&arena, a, 3);
+    puts("split a at 3:");
+    node_idx a_tail = pll_split(&arena, a, &at);
+    pll_print_list(&arena, a);
+    pll_print_list(&arena, a_tail);
+
+    puts("reverse b, concat b to a:");
+    pll_reverse(&arena, b);
+    pll_concat(&arena, a, b);
+    pll_print_list(&arena, a);
+    pll_print_list(&arena, b);
+
+    pll_arena_list_free(&arena, a);
+    pll_arena_list_free(&arena, b);
+    pll_arena_list_free(&arena, a_tail);
+    for (int i=0; i<opts.n_lists; i++)
+        pll_arena_list_free(&arena, roots[i]);
+    printf("arena nodes left: %zu\n", arena.len - 1);
+    xfree(roots);
+    pll_list_deinit(&arena);
 }
@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <stdatomic.h>
 #include "util.h"
 
 #undef USE_MADVISE
@@ -218,7 +219,70 @@ found:
 #endif
     return recombine_bit_idx(i, bit_idx);
 }
+long bitset_find_last_true_bit(struct bitset *bitset)
+{
+    if (!bitset->bit_len)
+        return -1;
+    struct idx_pair last_idx = resolve_bit_idx(bitset->bit_len - 1);
+    for (long i = last_idx.unsigned_idx; i >= 0; i--) {
+        unsigned v = bitset->data[i];
+        if (i == last_idx.unsigned_idx && last_idx.bit_idx != BITS_IN_UNSIGNED - 1)
+            v &= (1U << (last_idx.bit_idx + 1)) - 1; //ignore bits past bit_len
+        if (!v)
+            continue;
+#ifdef __GNUC__
+        return recombine_bit_idx(i, BITS_IN_UNSIGNED - 1 - __builtin_clz(v));
+#else
+        for (int bit_idx = BITS_IN_UNSIGNED - 1; bit_idx >= 0; bit_idx--) {
+            if (v & (1U << bit_idx))
+                return recombine_bit_idx(i, bit_idx);
+        }
+#endif
+    }
+    return -1;
+}
+
+size_t bitset_popcount(struct bitset *bitset)
+{
+    size_t n_unsigneds = n_needed_unsigneds(bitset->bit_len);
+    size_t count = 0;
+    for (size_t i=0; i<n_unsigneds; i++) {
+        unsigned v = bitset->data[i];
+        if (i == n_unsigneds - 1 && bits_excess(bitset->bit_len))
+            v &= UNSIGNED_ALL_BITS_ON >> bits_excess(bitset->bit_len); //ignore bits past bit_len
+#ifdef __GNUC__
+        count += __builtin_popcount(v);
+#else
+        for (; v; v &= v - 1)
+            count++;
+#endif
+    }
+    return count;
+}
+
+size_t bitset_bytes(struct bitset *bitset)
+{
+    return n_needed_unsigneds(bitset->bit_len) * sizeof(unsigned);
+}
 
+unsigned hash_u32(unsigned x)
+{
+    x ^= x >> 16;
+    x *= 0x85ebca6bU;
+    x ^= x >> 13;
+    x *= 0xc2b2ae35U;
+    x ^= x >> 16;
+    return x;
+}
+
+int thread_index(void)
+{
+    static atomic_int n_threads;
+    static _Thread_local int idx = -1;
+    if (idx == -1)
+        idx = atomic_fetch_add(&n_threads, 1);
+    return idx;
+}
 
 bool argv_get_int(int argc, const char **argv, const char *key, int *out_val, int default_val)
 {
@@ -21,7 +21,15 @@ bool bitset_get_bit(struct bitset *bitset, size_t bit_idx);
 void bitset_set_bit(struct bitset *bitset, size_t bit_idx, bool state);
 long bitset_find_true_bit(struct bitset *bitset,  size_t start_at_bit_idx);
 long bitset_find_false_bit(struct bitset *bitset,  size_t start_at_bit_idx);
+long bitset_find_last_true_bit(struct bitset *bitset); /*-1 if none*/
+size_t bitset_popcount(struct bitset *bitset);
+size_t bitset_bytes(struct bitset *bitset);
 
+/*integer mixing hash (murmur3 finalizer), use the low bits for power of 2 tables*/
+unsigned hash_u32(unsigned x);
+
+/*dense index of the calling thread (0, 1, 2, ... in order of first call), shared by the whole process*/
+int thread_index(void);
 
 bool argv_get_int(int argc, const char **argv, const char *key, int *out_val, int default_val);
 